@@ -0,0 +1,409 @@
+#include "gdwg/graph.hpp"
+#include "gdwg/traversal.hpp"
+#include "gdwg/weight_scan.hpp"
+
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+// Benchmarks for every gdwg::graph operation.
+// Each one runs on graphs of 1K to 10M edges, with int and std::string nodes. A graph of E
+// edges has E / edges_per_node nodes and random edges between them.
+namespace {
+	constexpr auto edges_per_node = std::int64_t{8};
+
+	template<typename N>
+	auto make_node(std::int64_t i) -> N {
+		if constexpr (std::is_same_v<N, std::string>) {
+			// Long enough to live outside the small string buffer, like a real key would.
+			return "benchmark-node-" + std::to_string(i);
+		}
+		else {
+			return static_cast<N>(i);
+		}
+	}
+
+	template<typename N>
+	struct graph_data {
+		std::vector<N> nodes;
+		std::vector<typename gdwg::graph<N, int>::value_type> edges;
+		gdwg::graph<N, int> graph;
+	};
+
+	// Builds (once per size) a graph with the given number of edges.
+	template<typename N>
+	auto data_for(std::int64_t edge_count) -> graph_data<N> const& {
+		static auto cache = std::map<std::int64_t, graph_data<N>>{};
+		auto found = cache.find(edge_count);
+		if (found != cache.end()) {
+			return found->second;
+		}
+		auto& data = cache[edge_count];
+		auto rng = std::mt19937_64{6771};
+		auto node_count = std::max<std::int64_t>(edge_count / edges_per_node, 2);
+		auto pick = std::uniform_int_distribution<std::int64_t>{0, node_count - 1};
+		for (auto i = std::int64_t{0}; i < node_count; ++i) {
+			data.nodes.push_back(make_node<N>(i));
+			data.graph.insert_node(data.nodes.back());
+		}
+		for (auto i = std::int64_t{0}; i < edge_count; ++i) {
+			auto const& from = data.nodes[static_cast<std::size_t>(pick(rng))];
+			auto const& to = data.nodes[static_cast<std::size_t>(pick(rng))];
+			if (data.graph.insert_edge(from, to, static_cast<int>(i))) {
+				data.edges.push_back({from, to, static_cast<int>(i)});
+			}
+		}
+		return data;
+	}
+
+	// Random (src, dst) pairs to query, picked up front so picking them isn't timed.
+	template<typename N>
+	auto query_pairs(graph_data<N> const& data) -> std::vector<std::pair<N, N>> {
+		auto rng = std::mt19937_64{1};
+		auto pick = std::uniform_int_distribution<std::size_t>{0, data.nodes.size() - 1};
+		auto pairs = std::vector<std::pair<N, N>>{};
+		for (auto i = 0; i < 1024; ++i) {
+			pairs.emplace_back(data.nodes[pick(rng)], data.nodes[pick(rng)]);
+		}
+		return pairs;
+	}
+
+	template<typename N>
+	using hashed_graph = gdwg::graph<N, int, std::allocator<N>, gdwg::hashed_lookup>;
+
+	// The same graph, with gdwg::hashed_lookup.
+	template<typename N>
+	auto hashed_copy(graph_data<N> const& data) -> hashed_graph<N> {
+		auto g = hashed_graph<N>(data.nodes.begin(), data.nodes.end());
+		for (auto const& edge : data.edges) {
+			g.insert_edge(edge.from, edge.to, edge.weight);
+		}
+		return g;
+	}
+
+	template<typename N>
+	void insert_node(benchmark::State& state) {
+		auto const& data = data_for<N>(state.range(0));
+		auto g = data.graph;
+		auto next = static_cast<std::int64_t>(data.nodes.size());
+		for (auto _ : state) {
+			benchmark::DoNotOptimize(g.insert_node(make_node<N>(next++)));
+		}
+		state.SetItemsProcessed(state.iterations());
+	}
+
+	template<typename N>
+	void insert_edge(benchmark::State& state) {
+		auto const& data = data_for<N>(state.range(0));
+		auto g = data.graph;
+		auto pairs = query_pairs(data);
+		// Weights past every existing one, so every insert adds a new edge.
+		auto weight = static_cast<int>(state.range(0));
+		auto i = std::size_t{0};
+		for (auto _ : state) {
+			auto const& [src, dst] = pairs[i++ % pairs.size()];
+			benchmark::DoNotOptimize(g.insert_edge(src, dst, weight++));
+		}
+		state.SetItemsProcessed(state.iterations());
+	}
+
+	template<typename N>
+	void erase_edge(benchmark::State& state) {
+		auto const& data = data_for<N>(state.range(0));
+		auto g = data.graph;
+		auto i = std::size_t{0};
+		for (auto _ : state) {
+			if (i == data.edges.size()) {
+				state.PauseTiming();
+				g = gdwg::graph<N, int>(data.graph);
+				i = 0;
+				state.ResumeTiming();
+			}
+			auto const& edge = data.edges[i++];
+			benchmark::DoNotOptimize(g.erase_edge(edge.from, edge.to, edge.weight));
+		}
+		state.SetItemsProcessed(state.iterations());
+	}
+
+	template<typename N>
+	void erase_node(benchmark::State& state) {
+		auto const& data = data_for<N>(state.range(0));
+		auto g = data.graph;
+		auto i = std::size_t{0};
+		for (auto _ : state) {
+			// Rebuild before the graph gets too small to be representative.
+			if (i == data.nodes.size() / 2) {
+				state.PauseTiming();
+				g = gdwg::graph<N, int>(data.graph);
+				i = 0;
+				state.ResumeTiming();
+			}
+			benchmark::DoNotOptimize(g.erase_node(data.nodes[i++]));
+		}
+		state.SetItemsProcessed(state.iterations());
+	}
+
+	template<typename N>
+	void merge_replace_node(benchmark::State& state) {
+		auto const& data = data_for<N>(state.range(0));
+		auto g = data.graph;
+		auto i = std::size_t{0};
+		for (auto _ : state) {
+			if (i + 1 >= data.nodes.size()) {
+				state.PauseTiming();
+				g = gdwg::graph<N, int>(data.graph);
+				i = 0;
+				state.ResumeTiming();
+			}
+			// Merge disjoint pairs, so no node keeps piling up edges from earlier merges.
+			g.merge_replace_node(data.nodes[i], data.nodes[i + 1]);
+			i += 2;
+		}
+		state.SetItemsProcessed(state.iterations());
+	}
+
+	template<typename N>
+	void is_connected(benchmark::State& state) {
+		auto const& data = data_for<N>(state.range(0));
+		auto g = data.graph;
+		auto pairs = query_pairs(data);
+		auto i = std::size_t{0};
+		for (auto _ : state) {
+			auto const& [src, dst] = pairs[i++ % pairs.size()];
+			benchmark::DoNotOptimize(g.is_connected(src, dst));
+		}
+		state.SetItemsProcessed(state.iterations());
+	}
+
+	template<typename N>
+	void is_connected_hashed(benchmark::State& state) {
+		auto const& data = data_for<N>(state.range(0));
+		auto g = hashed_copy(data);
+		auto pairs = query_pairs(data);
+		auto i = std::size_t{0};
+		for (auto _ : state) {
+			auto const& [src, dst] = pairs[i++ % pairs.size()];
+			benchmark::DoNotOptimize(g.is_connected(src, dst));
+		}
+		state.SetItemsProcessed(state.iterations());
+	}
+
+	template<typename N>
+	void connections(benchmark::State& state) {
+		auto const& data = data_for<N>(state.range(0));
+		auto g = data.graph;
+		auto pairs = query_pairs(data);
+		auto i = std::size_t{0};
+		for (auto _ : state) {
+			benchmark::DoNotOptimize(g.connections(pairs[i++ % pairs.size()].first));
+		}
+		state.SetItemsProcessed(state.iterations());
+	}
+
+	template<typename N>
+	void weights(benchmark::State& state) {
+		auto const& data = data_for<N>(state.range(0));
+		auto g = data.graph;
+		auto i = std::size_t{0};
+		for (auto _ : state) {
+			auto const& edge = data.edges[i++ % data.edges.size()];
+			benchmark::DoNotOptimize(g.weights(edge.from, edge.to));
+		}
+		state.SetItemsProcessed(state.iterations());
+	}
+
+	template<typename N>
+	void weights_view(benchmark::State& state) {
+		auto const& data = data_for<N>(state.range(0));
+		auto g = data.graph;
+		auto i = std::size_t{0};
+		for (auto _ : state) {
+			auto const& edge = data.edges[i++ % data.edges.size()];
+			for (auto const& weight : g.weights_view(edge.from, edge.to)) {
+				benchmark::DoNotOptimize(weight);
+			}
+		}
+		state.SetItemsProcessed(state.iterations());
+	}
+
+	template<typename N>
+	void neighbors(benchmark::State& state) {
+		auto const& data = data_for<N>(state.range(0));
+		auto g = data.graph;
+		auto pairs = query_pairs(data);
+		auto i = std::size_t{0};
+		for (auto _ : state) {
+			for (auto const& node : g.neighbors(pairs[i++ % pairs.size()].first)) {
+				benchmark::DoNotOptimize(node);
+			}
+		}
+		state.SetItemsProcessed(state.iterations());
+	}
+
+	template<typename N>
+	void find(benchmark::State& state) {
+		auto const& data = data_for<N>(state.range(0));
+		auto g = data.graph;
+		auto i = std::size_t{0};
+		for (auto _ : state) {
+			auto const& edge = data.edges[i++ % data.edges.size()];
+			benchmark::DoNotOptimize(g.find(edge.from, edge.to, edge.weight));
+		}
+		state.SetItemsProcessed(state.iterations());
+	}
+
+	template<typename N>
+	void find_hashed(benchmark::State& state) {
+		auto const& data = data_for<N>(state.range(0));
+		auto g = hashed_copy(data);
+		auto i = std::size_t{0};
+		for (auto _ : state) {
+			auto const& edge = data.edges[i++ % data.edges.size()];
+			benchmark::DoNotOptimize(g.find(edge.from, edge.to, edge.weight));
+		}
+		state.SetItemsProcessed(state.iterations());
+	}
+
+	template<typename N>
+	void copy(benchmark::State& state) {
+		auto const& data = data_for<N>(state.range(0));
+		for (auto _ : state) {
+			auto g = data.graph;
+			benchmark::DoNotOptimize(g);
+		}
+		state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(data.edges.size()));
+	}
+
+	// A copy followed by one speculative edit. Only the edited nodes' blocks get cloned.
+	template<typename N>
+	void copy_and_edit(benchmark::State& state) {
+		auto const& data = data_for<N>(state.range(0));
+		auto i = std::size_t{0};
+		for (auto _ : state) {
+			auto g = data.graph;
+			auto const& edge = data.edges[i++ % data.edges.size()];
+			benchmark::DoNotOptimize(g.erase_edge(edge.from, edge.to, edge.weight));
+		}
+		state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(data.edges.size()));
+	}
+
+	template<typename N>
+	void iterate(benchmark::State& state) {
+		auto const& data = data_for<N>(state.range(0));
+		for (auto _ : state) {
+			auto total = std::int64_t{0};
+			for (auto const& [from, to, weight] : data.graph) {
+				total += weight;
+			}
+			benchmark::DoNotOptimize(total);
+		}
+		state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(data.edges.size()));
+	}
+
+	template<typename N>
+	void iterate_edges(benchmark::State& state) {
+		auto const& data = data_for<N>(state.range(0));
+		for (auto _ : state) {
+			auto total = std::int64_t{0};
+			for (auto [from, to, weight] : data.graph.edges()) {
+				total += weight;
+			}
+			benchmark::DoNotOptimize(total);
+		}
+		state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(data.edges.size()));
+	}
+
+	template<typename N>
+	void bfs(benchmark::State& state) {
+		auto const& data = data_for<N>(state.range(0));
+		for (auto _ : state) {
+			benchmark::DoNotOptimize(gdwg::bfs(data.graph, data.nodes.front()));
+		}
+		state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(data.edges.size()));
+	}
+
+	template<typename N>
+	void parallel_bfs(benchmark::State& state) {
+		auto const& data = data_for<N>(state.range(0));
+		for (auto _ : state) {
+			benchmark::DoNotOptimize(gdwg::parallel_bfs(data.graph, data.nodes.front()));
+		}
+		state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(data.edges.size()));
+	}
+
+	// A graph where node 0 has edge_count edges out to 1K other nodes, for the weight scans.
+	template<typename N>
+	auto hub_for(std::int64_t edge_count) -> gdwg::graph<N, int> const& {
+		static auto cache = std::map<std::int64_t, gdwg::graph<N, int>>{};
+		auto found = cache.find(edge_count);
+		if (found != cache.end()) {
+			return found->second;
+		}
+		auto& g = cache[edge_count];
+		auto rng = std::mt19937_64{6771};
+		auto pick = std::uniform_int_distribution<std::int64_t>{1, 1'000};
+		g.insert_node(make_node<N>(0));
+		for (auto i = std::int64_t{1}; i <= 1'000; ++i) {
+			g.insert_node(make_node<N>(i));
+		}
+		auto edges = std::vector<typename gdwg::graph<N, int>::value_type>{};
+		for (auto i = std::int64_t{0}; i < edge_count; ++i) {
+			edges.push_back({make_node<N>(0), make_node<N>(pick(rng)), static_cast<int>(i)});
+		}
+		g.insert_edges(edges.begin(), edges.end());
+		return g;
+	}
+
+	template<typename N>
+	void out_weight_summary(benchmark::State& state) {
+		auto const& g = hub_for<N>(state.range(0));
+		auto const hub = make_node<N>(0);
+		for (auto _ : state) {
+			benchmark::DoNotOptimize(gdwg::out_weight_summary(g, hub));
+		}
+		state.SetItemsProcessed(state.iterations() * state.range(0));
+	}
+
+	template<typename N>
+	void edges_in_weight_range(benchmark::State& state) {
+		auto const& g = hub_for<N>(state.range(0));
+		auto const hub = make_node<N>(0);
+		// About one edge in a thousand.
+		auto const lo = static_cast<int>(state.range(0) / 2);
+		auto const hi = lo + static_cast<int>(state.range(0) / 1'000);
+		for (auto _ : state) {
+			benchmark::DoNotOptimize(gdwg::edges_in_weight_range(g, hub, lo, hi));
+		}
+		state.SetItemsProcessed(state.iterations() * state.range(0));
+	}
+} // namespace
+
+// Registers a benchmark for int and std::string nodes at every graph size.
+#define GDWG_GRAPH_BENCHMARK(name)                                                                 \
+	BENCHMARK_TEMPLATE(name, int)->RangeMultiplier(10)->Range(1'000, 10'000'000);                  \
+	BENCHMARK_TEMPLATE(name, std::string)->RangeMultiplier(10)->Range(1'000, 10'000'000)
+
+GDWG_GRAPH_BENCHMARK(insert_node);
+GDWG_GRAPH_BENCHMARK(insert_edge);
+GDWG_GRAPH_BENCHMARK(erase_edge);
+GDWG_GRAPH_BENCHMARK(erase_node);
+GDWG_GRAPH_BENCHMARK(merge_replace_node);
+GDWG_GRAPH_BENCHMARK(is_connected);
+GDWG_GRAPH_BENCHMARK(is_connected_hashed);
+GDWG_GRAPH_BENCHMARK(connections);
+GDWG_GRAPH_BENCHMARK(weights);
+GDWG_GRAPH_BENCHMARK(weights_view);
+GDWG_GRAPH_BENCHMARK(neighbors);
+GDWG_GRAPH_BENCHMARK(find);
+GDWG_GRAPH_BENCHMARK(find_hashed);
+GDWG_GRAPH_BENCHMARK(copy);
+GDWG_GRAPH_BENCHMARK(copy_and_edit);
+GDWG_GRAPH_BENCHMARK(iterate);
+GDWG_GRAPH_BENCHMARK(iterate_edges);
+GDWG_GRAPH_BENCHMARK(bfs);
+GDWG_GRAPH_BENCHMARK(parallel_bfs);
+GDWG_GRAPH_BENCHMARK(out_weight_summary);
+GDWG_GRAPH_BENCHMARK(edges_in_weight_range);
@@ -0,0 +1,743 @@
+#ifndef GDWG_BINARY_HPP
+#define GDWG_BINARY_HPP
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <istream>
+#include <iterator>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define GDWG_BINARY_HAS_MMAP 1
+#endif
+
+#include "gdwg/graph.hpp"
+
+// Binary save and load for gdwg::graph.
+//
+// The file is the CSR layout of frozen_graph: a header, the sorted node table, the offsets
+// array, the destination ID of every edge and the weight of every edge. Every section starts
+// on a 16 byte boundary so a mapped file can be read in place.
+//
+// A codec decides how a type is stored. Trivially copyable types are stored raw. Any other
+// type needs a codec with
+//     static auto encode(T const& value, std::vector<std::byte>& out) -> void; // append bytes
+//     static auto decode(std::byte const* data, std::size_t size) -> T;
+// which is then stored as an offsets array followed by the encoded bytes.
+namespace gdwg {
+	template<typename T>
+	struct codec;
+
+	// Raw fast path: the bytes of the object are the encoding.
+	template<typename T>
+	requires std::is_trivially_copyable_v<T>
+	struct codec<T> {
+		static constexpr bool raw = true;
+	};
+
+	template<>
+	struct codec<std::string> {
+		static auto encode(std::string const& value, std::vector<std::byte>& out) -> void {
+			auto const* first = reinterpret_cast<std::byte const*>(value.data());
+			out.insert(out.end(), first, first + value.size());
+		}
+
+		static auto decode(std::byte const* data, std::size_t size) -> std::string {
+			return std::string(reinterpret_cast<char const*>(data), size);
+		}
+	};
+
+	namespace detail {
+		// True when Codec stores values as their raw bytes.
+		template<typename Codec>
+		inline constexpr bool is_raw_codec = requires { requires Codec::raw; };
+
+		inline constexpr std::size_t section_alignment = 16;
+		inline constexpr std::uint32_t binary_version = 1;
+		inline constexpr std::uint32_t byte_order_mark = 0x01020304;
+		inline constexpr char binary_magic[8] = {'G', 'D', 'W', 'G', 'C', 'S', 'R', '\0'};
+
+		struct binary_header {
+			char magic[8];
+			std::uint32_t byte_order; // byte_order_mark as the saving machine wrote it
+			std::uint32_t version;
+			std::uint64_t node_count;
+			std::uint64_t edge_count;
+			std::uint64_t node_size; // sizeof(N) for raw nodes, 0 for encoded ones
+			std::uint64_t weight_size; // sizeof(E) for raw weights, 0 for encoded ones
+		};
+		static_assert(sizeof(binary_header) % section_alignment == 0);
+
+		[[noreturn]] inline auto corrupt_file() -> void {
+			throw std::runtime_error("Cannot load a gdwg::graph from a corrupt binary file");
+		}
+
+		// Returns how many bytes (count + extra) values of width bytes take up, or throws if a
+		// corrupt header makes that too big to represent.
+		inline auto section_bytes(std::size_t count, std::size_t width, std::size_t extra = 0)
+		   -> std::size_t {
+			auto const max = std::numeric_limits<std::size_t>::max();
+			if (count > max - extra || (width != 0 && count + extra > max / width)) {
+				corrupt_file();
+			}
+			return (count + extra) * width;
+		}
+
+		inline auto aligned(std::size_t size) noexcept -> std::size_t {
+			return (size + section_alignment - 1) / section_alignment * section_alignment;
+		}
+
+		// Writes size bytes and pads the stream up to the next section.
+		inline auto write_section(std::ostream& os, void const* data, std::size_t size) -> void {
+			static constexpr char padding[section_alignment] = {};
+			os.write(static_cast<char const*>(data), static_cast<std::streamsize>(size));
+			os.write(padding, static_cast<std::streamsize>(aligned(size) - size));
+		}
+
+		// Writes count values, raw or through Codec. get(i) returns the i-th value.
+		template<typename T, typename Codec, typename Get>
+		auto write_values(std::ostream& os, std::size_t count, Get get) -> void {
+			if constexpr (is_raw_codec<Codec>) {
+				static_assert(alignof(T) <= section_alignment);
+				auto values = std::vector<T>{};
+				values.reserve(count);
+				for (auto i = std::size_t{0}; i < count; ++i) {
+					values.push_back(get(i));
+				}
+				write_section(os, values.data(), count * sizeof(T));
+			}
+			else {
+				auto offsets = std::vector<std::uint64_t>{0};
+				auto bytes = std::vector<std::byte>{};
+				offsets.reserve(count + 1);
+				for (auto i = std::size_t{0}; i < count; ++i) {
+					Codec::encode(get(i), bytes);
+					offsets.push_back(bytes.size());
+				}
+				write_section(os, offsets.data(), offsets.size() * sizeof(std::uint64_t));
+				write_section(os, bytes.data(), bytes.size());
+			}
+		}
+
+		// A section of count values inside the file, raw or encoded by Codec.
+		template<typename T, typename Codec>
+		class value_section {
+		public:
+			value_section() = default;
+
+			// Reads the section at data + pos and moves pos past it.
+			value_section(std::byte const* data, std::size_t size, std::size_t& pos, std::size_t count) {
+				if constexpr (is_raw_codec<Codec>) {
+					values_ = reinterpret_cast<T const*>(
+					   check(data, size, pos, section_bytes(count, sizeof(T))));
+				}
+				else {
+					offsets_ = reinterpret_cast<std::uint64_t const*>(
+					   check(data, size, pos, section_bytes(count, sizeof(std::uint64_t), 1)));
+					// Every value has to lie inside the bytes that follow, in order.
+					if (offsets_[0] != 0) {
+						corrupt_file();
+					}
+					for (auto i = std::size_t{0}; i < count; ++i) {
+						if (offsets_[i + 1] < offsets_[i]) {
+							corrupt_file();
+						}
+					}
+					bytes_ = check(data, size, pos, offsets_[count]);
+				}
+			}
+
+			auto operator[](std::size_t i) const -> T {
+				if constexpr (is_raw_codec<Codec>) {
+					return values_[i];
+				}
+				else {
+					return Codec::decode(bytes_ + offsets_[i], offsets_[i + 1] - offsets_[i]);
+				}
+			}
+
+		private:
+			static auto check(std::byte const* data, std::size_t size, std::size_t& pos, std::size_t bytes)
+			   -> std::byte const* {
+				if (size - pos < bytes) {
+					throw std::runtime_error("Cannot load a gdwg::graph from a truncated binary file");
+				}
+				auto const* section = data + pos;
+				pos += aligned(bytes);
+				pos = std::min(pos, size);
+				return section;
+			}
+
+			T const* values_ = nullptr;
+			std::uint64_t const* offsets_ = nullptr;
+			std::byte const* bytes_ = nullptr;
+		};
+	} // namespace detail
+
+	// Writes a frozen snapshot in the binary format.
+	template<typename N, typename E, typename NodeCodec = codec<N>, typename WeightCodec = codec<E>>
+	auto save(frozen_graph<N, E> const& f, std::ostream& os) -> void {
+		auto header = detail::binary_header{};
+		std::memcpy(header.magic, detail::binary_magic, sizeof(header.magic));
+		header.byte_order = detail::byte_order_mark;
+		header.version = detail::binary_version;
+		header.node_count = static_cast<std::uint64_t>(f.size());
+		header.edge_count = f.edge_count();
+		header.node_size = detail::is_raw_codec<NodeCodec> ? sizeof(N) : 0;
+		header.weight_size = detail::is_raw_codec<WeightCodec> ? sizeof(E) : 0;
+		detail::write_section(os, &header, sizeof(header));
+		detail::write_values<N, NodeCodec>(os, f.nodes().size(), [&](std::size_t i) -> N const& {
+			return f.node(static_cast<typename frozen_graph<N, E>::id_type>(i));
+		});
+		auto offsets = std::vector<std::uint64_t>(f.offsets().begin(), f.offsets().end());
+		detail::write_section(os, offsets.data(), offsets.size() * sizeof(std::uint64_t));
+		detail::write_section(os,
+		                      f.destinations().data(),
+		                      f.destinations().size() * sizeof(typename frozen_graph<N, E>::id_type));
+		detail::write_values<E, WeightCodec>(os, f.edge_count(), [&](std::size_t i) -> E const& {
+			return f.edge_weights()[i];
+		});
+		if (!os) {
+			throw std::runtime_error("Cannot save a gdwg::graph to a stream that failed");
+		}
+	}
+
+	// Writes a graph in the binary format. This freezes it first.
+	template<typename N,
+	         typename E,
+	         typename NodeCodec = codec<N>,
+	         typename WeightCodec = codec<E>,
+	         typename Allocator,
+	         typename Lookup>
+	auto save(graph<N, E, Allocator, Lookup> const& g, std::ostream& os) -> void {
+		save<N, E, NodeCodec, WeightCodec>(g.freeze(), os);
+	}
+
+	template<typename N,
+	         typename E,
+	         typename NodeCodec = codec<N>,
+	         typename WeightCodec = codec<E>,
+	         typename Allocator,
+	         typename Lookup>
+	auto save(graph<N, E, Allocator, Lookup> const& g, std::filesystem::path const& path) -> void {
+		auto os = std::ofstream(path, std::ios::binary);
+		save<N, E, NodeCodec, WeightCodec>(g.freeze(), os);
+	}
+
+	// A read-only graph served straight from a binary file.
+	// Opening a path maps the file into memory, so no node or edge is read until a query needs
+	// it. Raw nodes and weights are read in place; encoded ones are decoded on each access.
+	template<typename N, typename E, typename NodeCodec = codec<N>, typename WeightCodec = codec<E>>
+	class mapped_graph {
+	public:
+		using id_type = std::uint32_t;
+		using value_type = typename graph<N, E>::value_type;
+
+		class iterator {
+		public:
+			using value_type = mapped_graph::value_type;
+			using reference = value_type;
+			using pointer = void;
+			using difference_type = std::ptrdiff_t;
+			using iterator_category = std::forward_iterator_tag;
+
+			iterator() = default;
+
+			iterator(mapped_graph const* g, std::size_t src, std::size_t pos)
+			: g_{g}
+			, src_{src}
+			, pos_{pos} {
+				skip_finished_sources();
+			}
+
+			auto operator*() const -> reference {
+				return value_type{g_->nodes_[src_], g_->nodes_[g_->dsts_[pos_]], g_->weights_[pos_]};
+			}
+
+			auto operator++() -> iterator& {
+				++pos_;
+				skip_finished_sources();
+				return *this;
+			}
+
+			auto operator++(int) -> iterator {
+				auto temp = *this;
+				++(*this);
+				return temp;
+			}
+
+			auto operator==(iterator const& other) const noexcept -> bool {
+				return pos_ == other.pos_;
+			}
+
+		private:
+			auto skip_finished_sources() noexcept -> void {
+				while (src_ < g_->node_count_ && pos_ >= g_->offsets_[src_ + 1]) {
+					++src_;
+				}
+			}
+
+			mapped_graph const* g_ = nullptr;
+			std::size_t src_ = 0;
+			std::size_t pos_ = 0;
+		};
+
+#ifdef GDWG_BINARY_HAS_MMAP
+		// Maps the file at path into memory.
+		explicit mapped_graph(std::filesystem::path const& path) {
+			auto fd = ::open(path.c_str(), O_RDONLY);
+			if (fd < 0) {
+				throw std::runtime_error("Cannot open " + path.string() + " as a gdwg binary graph");
+			}
+			struct stat info {};
+			auto const* mapping = MAP_FAILED;
+			if (::fstat(fd, &info) == 0 && info.st_size > 0) {
+				size_ = static_cast<std::size_t>(info.st_size);
+				mapping = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+			}
+			::close(fd);
+			if (mapping == MAP_FAILED) {
+				throw std::runtime_error("Cannot map " + path.string() + " as a gdwg binary graph");
+			}
+			mapping_ = mapping;
+			data_ = static_cast<std::byte const*>(mapping);
+			read_sections();
+		}
+#else
+		// Reads the whole file at path into memory.
+		explicit mapped_graph(std::filesystem::path const& path)
+		: mapped_graph(std::ifstream(path, std::ios::binary)) {}
+#endif
+
+		// Reads a binary graph from a stream into memory owned by this object.
+		explicit mapped_graph(std::istream& is)
+		: buffer_(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>()) {
+			size_ = buffer_.size();
+			data_ = reinterpret_cast<std::byte const*>(buffer_.data());
+			read_sections();
+		}
+
+		explicit mapped_graph(std::istream&& is)
+		: mapped_graph(is) {}
+
+		mapped_graph(mapped_graph const&) = delete;
+		auto operator=(mapped_graph const&) -> mapped_graph& = delete;
+
+		~mapped_graph() {
+#ifdef GDWG_BINARY_HAS_MMAP
+			if (mapping_ != nullptr) {
+				::munmap(const_cast<void*>(mapping_), size_);
+			}
+#endif
+		}
+
+		[[nodiscard]] auto begin() const -> iterator {
+			return iterator{this, 0, 0};
+		}
+
+		[[nodiscard]] auto end() const -> iterator {
+			return iterator{this, node_count_, edge_count_};
+		}
+
+		[[nodiscard]] auto empty() const noexcept -> bool {
+			return node_count_ == 0;
+		}
+
+		[[nodiscard]] auto size() const noexcept -> int {
+			return static_cast<int>(node_count_);
+		}
+
+		[[nodiscard]] auto edge_count() const noexcept -> std::size_t {
+			return edge_count_;
+		}
+
+		// The nodes are sorted, so this is a binary search over the node table.
+		[[nodiscard]] auto is_node(N const& value) const -> bool {
+			auto id = lower_bound(value);
+			return id < node_count_ && nodes_[id] == value;
+		}
+
+		[[nodiscard]] auto node_id(N const& value) const -> id_type {
+			if (!is_node(value)) {
+				throw std::runtime_error("Cannot call gdwg::mapped_graph<N, E>::node_id on a node "
+				                         "that doesn't exist");
+			}
+			return static_cast<id_type>(lower_bound(value));
+		}
+
+		[[nodiscard]] auto node(id_type id) const -> N {
+			return nodes_[id];
+		}
+
+		[[nodiscard]] auto is_connected(N const& src, N const& dst) const -> bool {
+			if (!is_node(src) || !is_node(dst)) {
+				throw std::runtime_error("Cannot call gdwg::mapped_graph<N, E>::is_connected if src or "
+				                         "dst node don't exist in the graph");
+			}
+			auto [first, last] = edge_range(node_id(src), node_id(dst));
+			return first != last;
+		}
+
+		[[nodiscard]] auto nodes() const -> std::vector<N> {
+			auto v = std::vector<N>{};
+			v.reserve(node_count_);
+			for (auto i = std::size_t{0}; i < node_count_; ++i) {
+				v.push_back(nodes_[i]);
+			}
+			return v;
+		}
+
+		[[nodiscard]] auto weights(N const& src, N const& dst) const -> std::vector<E> {
+			if (!is_node(src) || !is_node(dst)) {
+				throw std::runtime_error("Cannot call gdwg::mapped_graph<N, E>::weights if src or dst "
+				                         "node don't exist in the graph");
+			}
+			auto [first, last] = edge_range(node_id(src), node_id(dst));
+			auto v = std::vector<E>{};
+			for (auto e = first; e < last; ++e) {
+				v.push_back(weights_[e]);
+			}
+			return v;
+		}
+
+		[[nodiscard]] auto connections(N const& src) const -> std::vector<N> {
+			if (!is_node(src)) {
+				throw std::runtime_error("Cannot call gdwg::mapped_graph<N, E>::connections if src "
+				                         "doesn't exist in the graph");
+			}
+			auto id = node_id(src);
+			auto v = std::vector<N>{};
+			for (auto e = offsets_[id]; e < offsets_[id + 1]; ++e) {
+				// Edges are sorted by destination so duplicates are always adjacent.
+				if (e == offsets_[id] || dsts_[e] != dsts_[e - 1]) {
+					v.push_back(nodes_[dsts_[e]]);
+				}
+			}
+			return v;
+		}
+
+		// Builds an ordinary mutable graph holding everything in the file. The file keeps each
+		// node's edges in the graph's order, so each node's block is filled in one append.
+		template<typename Allocator = std::allocator<N>>
+		[[nodiscard]] auto to_graph(Allocator const& alloc = Allocator()) const -> graph<N, E, Allocator> {
+			using graph_id = typename graph<N, E, Allocator>::id_type;
+			auto g = graph<N, E, Allocator>(alloc);
+			auto ids = std::vector<graph_id>{};
+			ids.reserve(node_count_);
+			for (auto i = std::size_t{0}; i < node_count_; ++i) {
+				auto value = nodes_[i];
+				g.insert_node(value);
+				ids.push_back(g.node_id(value));
+			}
+			auto edges = std::vector<std::pair<graph_id, E>>{};
+			for (auto i = std::size_t{0}; i < node_count_; ++i) {
+				edges.clear();
+				for (auto e = offsets_[i]; e < offsets_[i + 1]; ++e) {
+					edges.emplace_back(ids[dsts_[e]], weights_[e]);
+				}
+				g.insert_edges(ids[i], edges.begin(), edges.end());
+			}
+			return g;
+		}
+
+	private:
+		// Checks the header and finds every section.
+		auto read_sections() -> void {
+			auto header = detail::binary_header{};
+			if (size_ < sizeof(header)) {
+				throw std::runtime_error("Cannot load a gdwg::graph from a file that is not a gdwg "
+				                         "binary graph");
+			}
+			std::memcpy(&header, data_, sizeof(header));
+			if (std::memcmp(header.magic, detail::binary_magic, sizeof(header.magic)) != 0
+			    || header.version != detail::binary_version)
+			{
+				throw std::runtime_error("Cannot load a gdwg::graph from a file that is not a gdwg "
+				                         "binary graph");
+			}
+			if (header.byte_order != detail::byte_order_mark
+			    || header.node_size != (detail::is_raw_codec<NodeCodec> ? sizeof(N) : 0)
+			    || header.weight_size != (detail::is_raw_codec<WeightCodec> ? sizeof(E) : 0))
+			{
+				throw std::runtime_error("Cannot load a gdwg::graph saved with a different byte order "
+				                         "or different node and weight types");
+			}
+			node_count_ = static_cast<std::size_t>(header.node_count);
+			edge_count_ = static_cast<std::size_t>(header.edge_count);
+			auto pos = sizeof(header);
+			nodes_ = detail::value_section<N, NodeCodec>(data_, size_, pos, node_count_);
+			offsets_ = reinterpret_cast<std::uint64_t const*>(
+			   data_ + section(pos, detail::section_bytes(node_count_, sizeof(std::uint64_t), 1)));
+			dsts_ = reinterpret_cast<id_type const*>(
+			   data_ + section(pos, detail::section_bytes(edge_count_, sizeof(id_type))));
+			weights_ = detail::value_section<E, WeightCodec>(data_, size_, pos, edge_count_);
+			check_edges();
+		}
+
+		// Checks that the offsets split the edges into one run per node and that every edge
+		// goes to a node, so no query can read outside the file.
+		auto check_edges() const -> void {
+			if (offsets_[0] != 0 || offsets_[node_count_] != edge_count_) {
+				detail::corrupt_file();
+			}
+			for (auto i = std::size_t{0}; i < node_count_; ++i) {
+				if (offsets_[i + 1] < offsets_[i]) {
+					detail::corrupt_file();
+				}
+			}
+			for (auto e = std::size_t{0}; e < edge_count_; ++e) {
+				if (dsts_[e] >= node_count_) {
+					detail::corrupt_file();
+				}
+			}
+		}
+
+		// Returns where a section of bytes starts and moves pos past it.
+		auto section(std::size_t& pos, std::size_t bytes) const -> std::size_t {
+			if (size_ - pos < bytes) {
+				throw std::runtime_error("Cannot load a gdwg::graph from a truncated binary file");
+			}
+			auto start = pos;
+			pos = std::min(pos + detail::aligned(bytes), size_);
+			return start;
+		}
+
+		// Returns the first node ID that is not less than value.
+		auto lower_bound(N const& value) const -> std::size_t {
+			auto first = std::size_t{0};
+			auto count = node_count_;
+			while (count > 0) {
+				auto step = count / 2;
+				if (nodes_[first + step] < value) {
+					first += step + 1;
+					count -= step + 1;
+				}
+				else {
+					count = step;
+				}
+			}
+			return first;
+		}
+
+		// Returns the [first, last) edge indices going from src to dst.
+		auto edge_range(id_type src, id_type dst) const -> std::pair<std::size_t, std::size_t> {
+			auto [lo, hi] = std::equal_range(dsts_ + offsets_[src], dsts_ + offsets_[src + 1], dst);
+			return {static_cast<std::size_t>(lo - dsts_), static_cast<std::size_t>(hi - dsts_)};
+		}
+
+		std::vector<char> buffer_; // File contents when read from a stream
+		void const* mapping_ = nullptr; // Mapped file, if there is one
+		std::byte const* data_ = nullptr;
+		std::size_t size_ = 0;
+		std::size_t node_count_ = 0;
+		std::size_t edge_count_ = 0;
+		detail::value_section<N, NodeCodec> nodes_;
+		std::uint64_t const* offsets_ = nullptr;
+		id_type const* dsts_ = nullptr;
+		detail::value_section<E, WeightCodec> weights_;
+	};
+
+	// Reads a binary graph back into an ordinary mutable graph.
+	template<typename N, typename E, typename NodeCodec = codec<N>, typename WeightCodec = codec<E>>
+	auto load(std::istream& is) -> graph<N, E> {
+		return mapped_graph<N, E, NodeCodec, WeightCodec>(is).to_graph();
+	}
+
+	template<typename N, typename E, typename NodeCodec = codec<N>, typename WeightCodec = codec<E>>
+	auto load(std::filesystem::path const& path) -> graph<N, E> {
+		return mapped_graph<N, E, NodeCodec, WeightCodec>(path).to_graph();
+	}
+
+	namespace detail {
+		inline constexpr char delta_magic[8] = {'G', 'D', 'W', 'G', 'D', 'L', 'T', '\0'};
+
+		struct delta_header {
+			char magic[8];
+			std::uint32_t byte_order; // byte_order_mark as the saving machine wrote it
+			std::uint32_t version;
+			std::uint64_t from_version;
+			std::uint64_t to_version;
+			std::uint64_t change_count;
+			std::uint64_t node_count; // Node values across all changes
+			std::uint64_t weight_count; // Weights across all changes
+			std::uint64_t node_size; // sizeof(N) for raw nodes, 0 for encoded ones
+			std::uint64_t weight_size; // sizeof(E) for raw weights, 0 for encoded ones
+			std::uint64_t reserved;
+		};
+		static_assert(sizeof(delta_header) % section_alignment == 0);
+	} // namespace detail
+
+	// Writes a delta in the binary format: a header, the kind of every change (its index in
+	// delta<N, E>::change), then every node value and every weight the changes carry, in
+	// order. Only the changes travel, so a replica can be synced without sending the graph.
+	template<typename N, typename E, typename NodeCodec = codec<N>, typename WeightCodec = codec<E>>
+	auto save(delta<N, E> const& d, std::ostream& os) -> void {
+		using delta_type = delta<N, E>;
+		auto kinds = std::vector<std::uint8_t>{};
+		auto nodes = std::vector<N const*>{};
+		auto weights = std::vector<E const*>{};
+		kinds.reserve(d.changes.size());
+		for (auto const& c : d.changes) {
+			kinds.push_back(static_cast<std::uint8_t>(c.index()));
+			std::visit(
+			   [&](auto const& change) {
+				   using T = std::decay_t<decltype(change)>;
+				   if constexpr (std::is_same_v<T, typename delta_type::node_inserted>
+				                 || std::is_same_v<T, typename delta_type::node_erased>)
+				   {
+					   nodes.push_back(&change.value);
+				   }
+				   else if constexpr (std::is_same_v<T, typename delta_type::node_replaced>
+				                      || std::is_same_v<T, typename delta_type::nodes_merged>)
+				   {
+					   nodes.push_back(&change.old_value);
+					   nodes.push_back(&change.new_value);
+				   }
+				   else if constexpr (std::is_same_v<T, typename delta_type::edge_inserted>
+				                      || std::is_same_v<T, typename delta_type::edge_erased>)
+				   {
+					   nodes.push_back(&change.src);
+					   nodes.push_back(&change.dst);
+					   weights.push_back(&change.weight);
+				   }
+			   },
+			   c);
+		}
+		auto header = detail::delta_header{};
+		std::memcpy(header.magic, detail::delta_magic, sizeof(header.magic));
+		header.byte_order = detail::byte_order_mark;
+		header.version = detail::binary_version;
+		header.from_version = d.from_version;
+		header.to_version = d.to_version;
+		header.change_count = kinds.size();
+		header.node_count = nodes.size();
+		header.weight_count = weights.size();
+		header.node_size = detail::is_raw_codec<NodeCodec> ? sizeof(N) : 0;
+		header.weight_size = detail::is_raw_codec<WeightCodec> ? sizeof(E) : 0;
+		detail::write_section(os, &header, sizeof(header));
+		detail::write_section(os, kinds.data(), kinds.size());
+		detail::write_values<N, NodeCodec>(os, nodes.size(), [&](std::size_t i) -> N const& {
+			return *nodes[i];
+		});
+		detail::write_values<E, WeightCodec>(os, weights.size(), [&](std::size_t i) -> E const& {
+			return *weights[i];
+		});
+		if (!os) {
+			throw std::runtime_error("Cannot save a gdwg::graph delta to a stream that failed");
+		}
+	}
+
+	// Reads a delta written by save().
+	template<typename N, typename E, typename NodeCodec = codec<N>, typename WeightCodec = codec<E>>
+	auto load_delta(std::istream& is) -> delta<N, E> {
+		using delta_type = delta<N, E>;
+		auto const buffer =
+		   std::vector<char>(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+		auto const* data = reinterpret_cast<std::byte const*>(buffer.data());
+		auto header = detail::delta_header{};
+		if (buffer.size() < sizeof(header)) {
+			throw std::runtime_error("Cannot load a gdwg::graph delta from a file that is not a gdwg "
+			                         "binary delta");
+		}
+		std::memcpy(&header, data, sizeof(header));
+		if (std::memcmp(header.magic, detail::delta_magic, sizeof(header.magic)) != 0
+		    || header.version != detail::binary_version)
+		{
+			throw std::runtime_error("Cannot load a gdwg::graph delta from a file that is not a gdwg "
+			                         "binary delta");
+		}
+		if (header.byte_order != detail::byte_order_mark
+		    || header.node_size != (detail::is_raw_codec<NodeCodec> ? sizeof(N) : 0)
+		    || header.weight_size != (detail::is_raw_codec<WeightCodec> ? sizeof(E) : 0))
+		{
+			throw std::runtime_error("Cannot load a gdwg::graph delta saved with a different byte "
+			                         "order or different node and weight types");
+		}
+		auto const change_count = static_cast<std::size_t>(header.change_count);
+		auto const node_count = static_cast<std::size_t>(header.node_count);
+		auto const weight_count = static_cast<std::size_t>(header.weight_count);
+		auto pos = sizeof(header);
+		using kind_section = detail::value_section<std::uint8_t, codec<std::uint8_t>>;
+		auto const kinds = kind_section(data, buffer.size(), pos, change_count);
+		auto const nodes = detail::value_section<N, NodeCodec>(data, buffer.size(), pos, node_count);
+		auto const weights =
+		   detail::value_section<E, WeightCodec>(data, buffer.size(), pos, weight_count);
+
+		auto d = delta_type{header.from_version, header.to_version, {}};
+		d.changes.reserve(change_count);
+		auto n = std::size_t{0};
+		auto w = std::size_t{0};
+		// Takes the node values and weights of the next change, in the order save() wrote them.
+		auto take = [&](std::size_t node_values, std::size_t weight_values) {
+			if (node_count - n < node_values || weight_count - w < weight_values) {
+				throw std::runtime_error("Cannot load a gdwg::graph delta from a truncated binary "
+				                         "file");
+			}
+			n += node_values;
+			w += weight_values;
+			return std::pair{n - node_values, w - weight_values};
+		};
+		// Kinds are indices into delta<N, E>::change.
+		for (auto i = std::size_t{0}; i < change_count; ++i) {
+			switch (kinds[i]) {
+			case 0: {
+				auto [first, _] = take(1, 0);
+				d.changes.emplace_back(typename delta_type::node_inserted{nodes[first]});
+				break;
+			}
+			case 1: {
+				auto [first, _] = take(1, 0);
+				d.changes.emplace_back(typename delta_type::node_erased{nodes[first]});
+				break;
+			}
+			case 2: {
+				auto [first, _] = take(2, 0);
+				d.changes.emplace_back(
+				   typename delta_type::node_replaced{nodes[first], nodes[first + 1]});
+				break;
+			}
+			case 3: {
+				auto [first, _] = take(2, 0);
+				d.changes.emplace_back(
+				   typename delta_type::nodes_merged{nodes[first], nodes[first + 1]});
+				break;
+			}
+			case 4: {
+				auto [first, weight] = take(2, 1);
+				auto change =
+				   typename delta_type::edge_inserted{nodes[first], nodes[first + 1], weights[weight]};
+				d.changes.emplace_back(std::move(change));
+				break;
+			}
+			case 5: {
+				auto [first, weight] = take(2, 1);
+				auto change =
+				   typename delta_type::edge_erased{nodes[first], nodes[first + 1], weights[weight]};
+				d.changes.emplace_back(std::move(change));
+				break;
+			}
+			case 6: d.changes.emplace_back(typename delta_type::cleared{}); break;
+			default:
+				throw std::runtime_error("Cannot load a gdwg::graph delta from a file that is not a "
+				                         "gdwg binary delta");
+			}
+		}
+		return d;
+	}
+} // namespace gdwg
+
+#endif // GDWG_BINARY_HPP
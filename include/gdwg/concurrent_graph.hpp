@@ -0,0 +1,224 @@
+#ifndef GDWG_CONCURRENT_GRAPH_HPP
+#define GDWG_CONCURRENT_GRAPH_HPP
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "gdwg/graph.hpp"
+
+// A graph shared between many reader threads and any number of writers. Readers take the
+// current published version and work on it, and never wait for a lock. Writers are serialised
+// and change a private staged graph in place, so a write costs what the same change costs on
+// a plain graph. The staged graph is published as one copy in one atomic store. A read that
+// finds unpublished writes and the writers idle publishes them itself. If a writer is busy,
+// the read takes the last published version and leaves a request, which that writer honours
+// before it lets go. A run of writes with no reads between them costs one copy in all, and a
+// copy shares every edge block, so it is O(V) rather than O(V + E). A reader always sees a
+// whole version: never half of a write, and never a version that changes while it is holding
+// it.
+namespace gdwg {
+	template<typename N,
+	         typename E,
+	         typename Allocator = std::allocator<N>,
+	         typename Lookup = ordered_lookup>
+	class concurrent_graph {
+	public:
+		using graph_type = graph<N, E, Allocator, Lookup>;
+		// A published version. It stays valid, and unchanged, for as long as it is held.
+		using snapshot = std::shared_ptr<graph_type const>;
+
+		/***************************************
+		**                                    **
+		**          Constructors              **
+		**                                    **
+		***************************************/
+
+		concurrent_graph()
+		: current_{std::make_shared<graph_type const>()} {}
+
+		explicit concurrent_graph(graph_type g)
+		: staged_{std::move(g)}
+		, current_{std::make_shared<graph_type const>(staged_)} {}
+
+		concurrent_graph(concurrent_graph const&) = delete;
+		auto operator=(concurrent_graph const&) -> concurrent_graph& = delete;
+
+		/***************************************
+		**                                    **
+		**          Readers                   **
+		**                                    **
+		***************************************/
+
+		// This function returns the current version. Hold on to it to make several reads
+		// against the same state, or to iterate while writers carry on. It never waits: while
+		// a writer holds the lock, it returns the last published version, which may not have
+		// the writes of the last moment yet.
+		[[nodiscard]] auto read() const -> snapshot {
+			if (stale_.load(std::memory_order_acquire)) {
+				auto lock = std::unique_lock<std::mutex>(write_mutex_, std::try_to_lock);
+				if (lock.owns_lock()) {
+					publish();
+				}
+				else {
+					wanted_.store(true, std::memory_order_release);
+				}
+			}
+			return current_.load(std::memory_order_acquire);
+		}
+
+		// This function returns how many writes have been made. Each one is seen by every read
+		// that starts after it returns and finds the writers idle.
+		[[nodiscard]] auto version() const noexcept -> std::uint64_t {
+			return version_.load(std::memory_order_acquire);
+		}
+
+		[[nodiscard]] auto is_node(N const& value) const -> bool {
+			return read()->is_node(value);
+		}
+
+		[[nodiscard]] auto empty() const -> bool {
+			return read()->empty();
+		}
+
+		[[nodiscard]] auto is_connected(N const& src, N const& dst) const -> bool {
+			return read()->is_connected(src, dst);
+		}
+
+		[[nodiscard]] auto nodes() const -> std::vector<N> {
+			return read()->nodes();
+		}
+
+		[[nodiscard]] auto weights(N const& src, N const& dst) const -> std::vector<E> {
+			return read()->weights(src, dst);
+		}
+
+		[[nodiscard]] auto connections(N const& src) const -> std::vector<N> {
+			return read()->connections(src);
+		}
+
+		// The batch queries answer every query against the same version.
+		[[nodiscard]] auto is_connected_batch(std::span<std::pair<N, N> const> queries,
+		                                      unsigned threads = 1) const -> std::vector<bool> {
+			return read()->is_connected_batch(queries, threads);
+		}
+
+		[[nodiscard]] auto connections_batch(std::span<N const> sources, unsigned threads = 1) const
+		   -> std::vector<std::vector<N>> {
+			return read()->connections_batch(sources, threads);
+		}
+
+		/***************************************
+		**                                    **
+		**          Writers                   **
+		**                                    **
+		***************************************/
+
+		// This function applies f to a private copy of the staged graph and stages the result.
+		// Everything f does becomes visible at once, so batch related writes into a single
+		// update. If f throws, nothing changes. Readers don't wait for f; they keep the last
+		// published version until it returns.
+		template<typename F>
+		auto update(F&& f) -> std::invoke_result_t<F&, graph_type&> {
+			auto lock = std::lock_guard<std::mutex>(write_mutex_);
+			auto next = graph_type(staged_);
+			if constexpr (std::is_void_v<std::invoke_result_t<F&, graph_type&>>) {
+				f(next);
+				stage(std::move(next));
+			}
+			else {
+				auto result = f(next);
+				stage(std::move(next));
+				return result;
+			}
+		}
+
+		auto insert_node(N const& value) -> bool {
+			return write([&](graph_type& g) { return g.insert_node(value); });
+		}
+
+		auto insert_edge(N const& src, N const& dst, E const& weight) -> bool {
+			return write([&](graph_type& g) { return g.insert_edge(src, dst, weight); });
+		}
+
+		auto replace_node(N const& old_data, N const& new_data) -> bool {
+			return write([&](graph_type& g) { return g.replace_node(old_data, new_data); });
+		}
+
+		auto merge_replace_node(N const& old_data, N const& new_data) -> void {
+			write([&](graph_type& g) { g.merge_replace_node(old_data, new_data); });
+		}
+
+		auto erase_node(N const& value) -> bool {
+			return write([&](graph_type& g) { return g.erase_node(value); });
+		}
+
+		auto erase_edge(N const& src, N const& dst, E const& weight) -> bool {
+			return write([&](graph_type& g) { return g.erase_edge(src, dst, weight); });
+		}
+
+		auto clear() -> void {
+			write([](graph_type& g) { g.clear(); });
+		}
+
+	private:
+		// Applies one modifier straight to the staged graph. The modifiers check their
+		// arguments before changing anything, so one that throws leaves nothing to undo.
+		template<typename F>
+		auto write(F f) -> std::invoke_result_t<F&, graph_type&> {
+			auto lock = std::lock_guard<std::mutex>(write_mutex_);
+			auto const before = staged_.version();
+			if constexpr (std::is_void_v<std::invoke_result_t<F&, graph_type&>>) {
+				f(staged_);
+				written(before);
+			}
+			else {
+				auto result = f(staged_);
+				written(before);
+				return result;
+			}
+		}
+
+		auto stage(graph_type next) -> void {
+			auto const before = staged_.version();
+			staged_ = std::move(next);
+			written(before);
+		}
+
+		// Counts a write, and marks the staged graph for publishing if the write changed it.
+		// A reader that found the lock taken is waiting for it, so it is published now.
+		// The caller holds write_mutex_.
+		auto written(std::uint64_t before) -> void {
+			if (staged_.version() != before) {
+				stale_.store(true, std::memory_order_release);
+			}
+			version_.fetch_add(1, std::memory_order_release);
+			if (wanted_.load(std::memory_order_acquire)) {
+				publish();
+			}
+		}
+
+		// Publishes a copy of the staged graph if it has writes readers haven't seen yet.
+		// The caller holds write_mutex_.
+		auto publish() const -> void {
+			wanted_.store(false, std::memory_order_relaxed);
+			if (stale_.load(std::memory_order_relaxed)) {
+				current_.store(std::make_shared<graph_type const>(staged_), std::memory_order_release);
+				stale_.store(false, std::memory_order_release);
+			}
+		}
+
+		graph_type staged_; // The latest state, only touched under write_mutex_
+		mutable std::atomic<snapshot> current_;
+		mutable std::atomic<bool> stale_{false}; // Whether staged_ has writes current_ lacks
+		mutable std::atomic<bool> wanted_{false}; // Whether a reader found the lock taken
+		std::atomic<std::uint64_t> version_{0};
+		mutable std::mutex write_mutex_;
+	};
+} // namespace gdwg
+
+#endif // GDWG_CONCURRENT_GRAPH_HPP
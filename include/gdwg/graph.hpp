@@ -1,119 +1,2927 @@
 #ifndef GDWG_GRAPH_HPP
 #define GDWG_GRAPH_HPP
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
 #include <iostream>
 #include <iterator>
 #include <map>
 #include <memory>
-#include <set>
+#include <memory_resource>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+#include <type_traits>
 #include <utility>
+#include <variant>
+#include <vector>
 
 // TODO: Make this graph generic
 //       ... this won't just compile
 //       straight away
 namespace gdwg {
 	template<typename N, typename E>
+	class frozen_graph;
+
+	/***************************************
+	**                                    **
+	**          Lookup policies           **
+	**                                    **
+	***************************************/
+	// Nodes and edges are found by walking the ordered map and sets. This costs nothing extra
+	// and is the default.
+	struct ordered_lookup {};
+
+	// Nodes and (src, dst) pairs are also kept in open addressing hash tables, so is_node,
+	// is_connected, find and the node lookups of every modifier take expected O(1) time.
+	// Storage and iteration stay ordered. N must be hashable with std::hash and comparable
+	// with ==.
+	struct hashed_lookup {};
+
+	namespace detail {
+		// Finaliser from splitmix64. std::hash is often the identity for integers, and the
+		// tables below use the low bits of the hash as the slot.
+		constexpr auto mix_hash(std::uint64_t h) noexcept -> std::uint64_t {
+			h ^= h >> 30;
+			h *= 0xbf58476d1ce4e5b9ULL;
+			h ^= h >> 27;
+			h *= 0x94d049bb133111ebULL;
+			return h ^ (h >> 31);
+		}
+
+		// A linear probing table of Slots. A Slot knows its hash() and whether it is empty().
+		// Erasing shifts the following slots back, so there are no tombstones to skip.
+		template<typename Slot, typename Allocator>
+		class probe_table {
+		public:
+			explicit probe_table(Allocator const& alloc)
+			: slots_(alloc) {}
+
+			probe_table(probe_table const& other, Allocator const& alloc)
+			: slots_(other.slots_, alloc)
+			, size_{other.size_} {}
+
+			// Returns the slot that matches, or nullptr.
+			template<typename Match>
+			[[nodiscard]] auto find(std::uint64_t hash, Match match) const -> Slot const* {
+				if (slots_.empty()) {
+					return nullptr;
+				}
+				auto& slot = slots_[position(hash, match)];
+				return slot.empty() ? nullptr : &slot;
+			}
+
+			template<typename Match>
+			[[nodiscard]] auto find(std::uint64_t hash, Match match) -> Slot* {
+				return const_cast<Slot*>(std::as_const(*this).find(hash, match));
+			}
+
+			// Returns the slot that matches. If there is none, an empty slot is set aside for it
+			// and the caller fills it in.
+			template<typename Match>
+			auto find_or_reserve(std::uint64_t hash, Match match) -> Slot& {
+				// Keep the table at most half full.
+				if (2 * (size_ + 1) > slots_.size()) {
+					grow();
+				}
+				auto& slot = slots_[position(hash, match)];
+				if (slot.empty()) {
+					++size_;
+				}
+				return slot;
+			}
+
+			template<typename Match>
+			auto erase(std::uint64_t hash, Match match) noexcept -> void {
+				if (slots_.empty()) {
+					return;
+				}
+				auto hole = position(hash, match);
+				if (slots_[hole].empty()) {
+					return;
+				}
+				auto mask = slots_.size() - 1;
+				for (auto next = (hole + 1) & mask; !slots_[next].empty(); next = (next + 1) & mask) {
+					// A slot may only move back if the hole is on its probe path.
+					auto home = static_cast<std::size_t>(slots_[next].hash()) & mask;
+					if (((next - home) & mask) >= ((next - hole) & mask)) {
+						slots_[hole] = slots_[next];
+						hole = next;
+					}
+				}
+				slots_[hole] = Slot{};
+				--size_;
+			}
+
+			auto clear() noexcept -> void {
+				slots_.clear();
+				size_ = 0;
+			}
+
+		private:
+			template<typename Match>
+			auto position(std::uint64_t hash, Match match) const noexcept -> std::size_t {
+				auto mask = slots_.size() - 1;
+				auto i = static_cast<std::size_t>(hash) & mask;
+				while (!slots_[i].empty() && !match(slots_[i])) {
+					i = (i + 1) & mask;
+				}
+				return i;
+			}
+
+			auto grow() -> void {
+				auto old = std::vector<Slot, Allocator>(std::max<std::size_t>(16, 2 * slots_.size()),
+				                                        slots_.get_allocator());
+				old.swap(slots_);
+				auto mask = slots_.size() - 1;
+				for (auto const& slot : old) {
+					if (!slot.empty()) {
+						auto i = static_cast<std::size_t>(slot.hash()) & mask;
+						while (!slots_[i].empty()) {
+							i = (i + 1) & mask;
+						}
+						slots_[i] = slot;
+					}
+				}
+			}
+
+			std::vector<Slot, Allocator> slots_;
+			std::size_t size_ = 0;
+		};
+
+		// Nothing to maintain for ordered_lookup.
+		template<typename N, typename Allocator>
+		struct no_lookup_index {
+			explicit no_lookup_index(Allocator const&) noexcept {}
+			no_lookup_index(no_lookup_index const&, Allocator const&) noexcept {}
+
+			template<typename Table>
+			auto insert_node(N const&, std::uint32_t, Table const&) noexcept -> void {}
+			template<typename Table>
+			auto erase_node(N const&, Table const&) noexcept -> void {}
+			auto rename_node(N const&, N const&, std::uint32_t) noexcept -> void {}
+			auto add_edges(std::uint32_t, std::uint32_t, std::size_t) noexcept -> void {}
+			auto remove_edge(std::uint32_t, std::uint32_t) noexcept -> void {}
+			auto remove_edges(std::uint32_t, std::uint32_t) noexcept -> void {}
+			auto clear() noexcept -> void {}
+		};
+
+		// The hash indexes behind hashed_lookup: node value -> ID, and (src ID, dst ID) -> the
+		// number of edges between them.
+		template<typename N, typename Allocator>
+		requires requires(N const& n) {
+			{ std::hash<N>{}(n) } -> std::convertible_to<std::size_t>;
+			{ n == n } -> std::convertible_to<bool>;
+		}
+		class hashed_lookup_index {
+			struct node_slot {
+				static constexpr auto none = ~std::uint32_t{0};
+
+				std::uint32_t hash_bits = 0; // The low half of the mixed hash of the node
+				std::uint32_t id = none;
+
+				[[nodiscard]] auto hash() const noexcept -> std::uint64_t {
+					return hash_bits;
+				}
+				[[nodiscard]] auto empty() const noexcept -> bool {
+					return id == none;
+				}
+			};
+
+			struct edge_slot {
+				std::uint64_t key = 0; // src ID in the high half, dst ID in the low half
+				std::size_t count = 0;
+
+				[[nodiscard]] auto hash() const noexcept -> std::uint64_t {
+					return mix_hash(key);
+				}
+				[[nodiscard]] auto empty() const noexcept -> bool {
+					return count == 0;
+				}
+			};
+
+			template<typename T>
+			using rebind_alloc = typename std::allocator_traits<Allocator>::template rebind_alloc<T>;
+
+		public:
+			static constexpr auto npos = node_slot::none;
+
+			explicit hashed_lookup_index(Allocator const& alloc)
+			: nodes_(alloc)
+			, edges_(alloc) {}
+
+			// The copy keeps the same IDs as the graph it came from, so the tables carry over.
+			hashed_lookup_index(hashed_lookup_index const& other, Allocator const& alloc)
+			: nodes_(other.nodes_, alloc)
+			, edges_(other.edges_, alloc) {}
+
+			// Returns the ID of value, or npos. table maps IDs to node values.
+			template<typename Table>
+			[[nodiscard]] auto find_node(N const& value, Table const& table) const -> std::uint32_t {
+				auto hash = node_hash(value);
+				auto slot = nodes_.find(hash, matches(value, hash, table));
+				return slot ? slot->id : npos;
+			}
+
+			template<typename Table>
+			auto insert_node(N const& value, std::uint32_t id, Table const& table) -> void {
+				auto hash = node_hash(value);
+				nodes_.find_or_reserve(hash, matches(value, hash, table)) = node_slot{hash, id};
+			}
+
+			template<typename Table>
+			auto erase_node(N const& value, Table const& table) -> void {
+				auto hash = node_hash(value);
+				nodes_.erase(hash, matches(value, hash, table));
+			}
+
+			// Moves node id from the slot of old_value to the slot of new_value, which isn't a
+			// node yet. Only hashing can throw, and both hashes are taken before anything moves.
+			// Erasing leaves room for the new slot, so the table doesn't grow.
+			auto rename_node(N const& old_value, N const& new_value, std::uint32_t id) -> void {
+				auto const old_hash = node_hash(old_value);
+				auto const new_hash = node_hash(new_value);
+				auto by_id = [id](node_slot const& s) { return s.id == id; };
+				nodes_.erase(old_hash, by_id);
+				nodes_.find_or_reserve(new_hash, by_id) = node_slot{new_hash, id};
+			}
+
+			[[nodiscard]] auto is_connected(std::uint32_t src, std::uint32_t dst) const noexcept -> bool {
+				auto key = edge_key(src, dst);
+				return edges_.find(mix_hash(key), [key](edge_slot const& s) { return s.key == key; })
+				       != nullptr;
+			}
+
+			auto add_edges(std::uint32_t src, std::uint32_t dst, std::size_t count) -> void {
+				auto key = edge_key(src, dst);
+				auto& slot = edges_.find_or_reserve(mix_hash(key),
+				                                    [key](edge_slot const& s) { return s.key == key; });
+				slot.key = key;
+				slot.count += count;
+			}
+
+			// Takes away one edge from src to dst.
+			auto remove_edge(std::uint32_t src, std::uint32_t dst) noexcept -> void {
+				auto key = edge_key(src, dst);
+				auto match = [key](edge_slot const& s) { return s.key == key; };
+				auto slot = edges_.find(mix_hash(key), match);
+				if (slot == nullptr) {
+					return;
+				}
+				// An empty slot is one with no edges, so the last one has to go through erase.
+				if (slot->count == 1) {
+					edges_.erase(mix_hash(key), match);
+				}
+				else {
+					--(slot->count);
+				}
+			}
+
+			// Takes away every edge from src to dst.
+			auto remove_edges(std::uint32_t src, std::uint32_t dst) noexcept -> void {
+				auto key = edge_key(src, dst);
+				edges_.erase(mix_hash(key), [key](edge_slot const& s) { return s.key == key; });
+			}
+
+			auto clear() noexcept -> void {
+				nodes_.clear();
+				edges_.clear();
+			}
+
+		private:
+			// Only the low half is kept, so the slot is the same whether it is worked out from
+			// the value or from the stored hash_bits.
+			static auto node_hash(N const& value) -> std::uint32_t {
+				auto hash = static_cast<std::uint64_t>(std::hash<N>{}(value));
+				return static_cast<std::uint32_t>(mix_hash(hash));
+			}
+
+			static auto edge_key(std::uint32_t src, std::uint32_t dst) noexcept -> std::uint64_t {
+				return (std::uint64_t{src} << 32) | dst;
+			}
+
+			template<typename Table>
+			static auto matches(N const& value, std::uint32_t hash, Table const& table) {
+				return [&value, &table, hash](node_slot const& s) {
+					return s.hash_bits == hash && *table[s.id] == value;
+				};
+			}
+
+			probe_table<node_slot, rebind_alloc<node_slot>> nodes_;
+			probe_table<edge_slot, rebind_alloc<edge_slot>> edges_;
+		};
+
+		// Helpers for the algorithms that walk a graph G through its node IDs.
+		template<typename G>
+		using id_of = typename G::id_type;
+
+		template<typename G>
+		auto index(id_of<G> id) noexcept -> std::size_t {
+			return static_cast<std::size_t>(id);
+		}
+
+		template<typename Lookup, typename N, typename Allocator>
+		struct lookup_index_for {
+			using type = no_lookup_index<N, Allocator>;
+		};
+
+		template<typename N, typename Allocator>
+		struct lookup_index_for<hashed_lookup, N, Allocator> {
+			using type = hashed_lookup_index<N, Allocator>;
+		};
+
+		// Smaller pieces of work than this aren't worth a thread of their own.
+		constexpr auto min_chunk = std::size_t{256};
+
+		inline auto thread_count(unsigned threads) -> unsigned {
+			return threads == 0 ? std::max(1U, std::thread::hardware_concurrency()) : threads;
+		}
+
+		inline auto worker_count(unsigned threads, std::size_t count) -> std::size_t {
+			auto chunks = (count + min_chunk - 1) / min_chunk;
+			return std::max<std::size_t>(1, std::min<std::size_t>(threads, chunks));
+		}
+
+		// Splits [0, count) into one chunk per worker and runs work(worker, first, last) on
+		// each. A single worker runs on the calling thread.
+		template<typename Work>
+		auto parallel_for(std::size_t workers, std::size_t count, Work work) -> void {
+			if (workers <= 1) {
+				work(std::size_t{0}, std::size_t{0}, count);
+				return;
+			}
+			auto pool = std::vector<std::thread>{};
+			auto chunk = (count + workers - 1) / workers;
+			for (auto t = std::size_t{0}; t < workers; ++t) {
+				pool.emplace_back(work,
+				                  t,
+				                  std::min(count, t * chunk),
+				                  std::min(count, (t + 1) * chunk));
+			}
+			for (auto& t : pool) {
+				t.join();
+			}
+		}
+
+		// A vector that keeps up to Inline elements inside itself and only goes to the heap once
+		// it holds more. Trivially copyable elements are shifted and copied with memmove instead
+		// of one at a time.
+		template<typename T, std::size_t Inline, typename Allocator>
+		class small_vector {
+			static_assert(Inline > 0);
+			using alloc_traits = std::allocator_traits<Allocator>;
+			static constexpr bool trivial = std::is_trivially_copyable_v<T>;
+
+		public:
+			using value_type = T;
+			using allocator_type = Allocator;
+			using size_type = std::size_t;
+			using difference_type = std::ptrdiff_t;
+			using reference = T&;
+			using const_reference = T const&;
+			using iterator = T*;
+			using const_iterator = T const*;
+
+			small_vector() noexcept(noexcept(Allocator()))
+			: small_vector(Allocator()) {}
+
+			explicit small_vector(Allocator const& alloc) noexcept
+			: alloc_{alloc} {}
+
+			small_vector(small_vector const& other)
+			: small_vector(other, alloc_traits::select_on_container_copy_construction(other.alloc_)) {}
+
+			small_vector(small_vector const& other, Allocator const& alloc)
+			: alloc_{alloc} {
+				insert(end(), other.begin(), other.end());
+			}
+
+			small_vector(small_vector&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+			: alloc_{std::move(other.alloc_)} {
+				take(other);
+			}
+
+			auto operator=(small_vector const& other) -> small_vector& {
+				if (this != &other) {
+					clear();
+					insert(end(), other.begin(), other.end());
+				}
+				return *this;
+			}
+
+			auto operator=(small_vector&& other) -> small_vector& {
+				if (this != &other) {
+					clear();
+					release();
+					if constexpr (alloc_traits::propagate_on_container_move_assignment::value) {
+						alloc_ = std::move(other.alloc_);
+					}
+					if (alloc_ == other.alloc_) {
+						take(other);
+					}
+					else {
+						insert(end(), std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+						other.clear();
+					}
+				}
+				return *this;
+			}
+
+			~small_vector() {
+				clear();
+				release();
+			}
+
+			[[nodiscard]] auto begin() noexcept -> iterator {
+				return data();
+			}
+
+			[[nodiscard]] auto begin() const noexcept -> const_iterator {
+				return data();
+			}
+
+			[[nodiscard]] auto end() noexcept -> iterator {
+				return data() + size_;
+			}
+
+			[[nodiscard]] auto end() const noexcept -> const_iterator {
+				return data() + size_;
+			}
+
+			[[nodiscard]] auto cbegin() const noexcept -> const_iterator {
+				return begin();
+			}
+
+			[[nodiscard]] auto cend() const noexcept -> const_iterator {
+				return end();
+			}
+
+			[[nodiscard]] auto data() noexcept -> T* {
+				return on_heap() ? storage_.heap : reinterpret_cast<T*>(storage_.inline_bytes);
+			}
+
+			[[nodiscard]] auto data() const noexcept -> T const* {
+				return on_heap() ? storage_.heap : reinterpret_cast<T const*>(storage_.inline_bytes);
+			}
+
+			[[nodiscard]] auto operator[](size_type i) noexcept -> T& {
+				return data()[i];
+			}
+
+			[[nodiscard]] auto operator[](size_type i) const noexcept -> T const& {
+				return data()[i];
+			}
+
+			[[nodiscard]] auto size() const noexcept -> size_type {
+				return size_;
+			}
+
+			[[nodiscard]] auto empty() const noexcept -> bool {
+				return size_ == 0;
+			}
+
+			[[nodiscard]] auto capacity() const noexcept -> size_type {
+				return capacity_;
+			}
+
+			// True once the elements have outgrown the inline storage.
+			[[nodiscard]] auto on_heap() const noexcept -> bool {
+				return capacity_ > Inline;
+			}
+
+			[[nodiscard]] auto get_allocator() const noexcept -> allocator_type {
+				return alloc_;
+			}
+
+			auto reserve(size_type count) -> void {
+				if (count > capacity_) {
+					grow_to(count);
+				}
+			}
+
+			auto clear() noexcept -> void {
+				if constexpr (!trivial) {
+					std::destroy(begin(), end());
+				}
+				size_ = 0;
+			}
+
+			auto insert(const_iterator pos, T const& value) -> iterator {
+				// value may live in this vector, which growing would move.
+				auto copy = value;
+				return insert(pos, std::make_move_iterator(&copy), std::make_move_iterator(&copy + 1));
+			}
+
+			template<typename ForwardIt>
+			auto insert(const_iterator pos, ForwardIt first, ForwardIt last) -> iterator {
+				auto offset = pos - begin();
+				auto count = static_cast<size_type>(std::distance(first, last));
+				if (size_ + count > capacity_) {
+					grow_to(std::max(size_ + count, capacity_ * 2));
+				}
+				auto* at = data() + offset;
+				if constexpr (trivial) {
+					std::memmove(at + count, at, (size_ - static_cast<size_type>(offset)) * sizeof(T));
+					std::uninitialized_copy(first, last, at);
+					size_ += count;
+				}
+				else {
+					// Build the new elements past the end, then rotate them into place.
+					auto* old_end = end();
+					std::uninitialized_copy(first, last, old_end);
+					size_ += count;
+					std::rotate(at, old_end, end());
+				}
+				return at;
+			}
+
+			auto erase(const_iterator pos) -> iterator {
+				return erase(pos, pos + 1);
+			}
+
+			auto erase(const_iterator first, const_iterator last) -> iterator {
+				auto* from = begin() + (first - begin());
+				auto* to = begin() + (last - begin());
+				if constexpr (trivial) {
+					std::memmove(from, to, static_cast<size_type>(end() - to) * sizeof(T));
+				}
+				else {
+					std::destroy(std::move(to, end(), from), end());
+				}
+				size_ -= static_cast<size_type>(to - from);
+				return from;
+			}
+
+		private:
+			auto grow_to(size_type count) -> void {
+				auto* fresh = alloc_traits::allocate(alloc_, count);
+				if constexpr (trivial) {
+					if (size_ != 0) {
+						std::memcpy(fresh, data(), size_ * sizeof(T));
+					}
+				}
+				else {
+					try {
+						std::uninitialized_move(begin(), end(), fresh);
+					} catch (...) {
+						alloc_traits::deallocate(alloc_, fresh, count);
+						throw;
+					}
+					std::destroy(begin(), end());
+				}
+				release();
+				storage_.heap = fresh;
+				capacity_ = count;
+			}
+
+			// Gives back the heap storage. The elements have to have been destroyed or moved.
+			auto release() noexcept -> void {
+				if (on_heap()) {
+					alloc_traits::deallocate(alloc_, storage_.heap, capacity_);
+				}
+				capacity_ = Inline;
+			}
+
+			// Takes the elements of other, leaving it empty.
+			auto take(small_vector& other) noexcept(std::is_nothrow_move_constructible_v<T>) -> void {
+				if (other.on_heap()) {
+					storage_.heap = other.storage_.heap;
+					capacity_ = other.capacity_;
+					size_ = other.size_;
+					other.capacity_ = Inline;
+					other.size_ = 0;
+				}
+				else {
+					std::uninitialized_move(other.begin(), other.end(), data());
+					size_ = other.size_;
+					other.clear();
+				}
+			}
+
+			// The heap pointer shares its space with the inline elements it replaces.
+			union storage {
+				alignas(T) std::byte inline_bytes[sizeof(T) * Inline];
+				T* heap;
+			} storage_;
+			size_type size_ = 0;
+			size_type capacity_ = Inline;
+			[[no_unique_address]] Allocator alloc_;
+		};
+
+		// How many edges a node keeps inline before its edges go to the heap. Most nodes of
+		// real graphs have no more out-edges than this.
+		inline constexpr std::size_t inline_edges = 4;
+
+		// A block of storage that copies of a graph share until one of them writes to it, at
+		// which point the writer takes its own copy (copy-on-write). An empty block has no
+		// storage at all.
+		template<typename T>
+		class shared_block {
+		public:
+			shared_block() = default;
+
+			// Copies the contents of other into storage from alloc instead of sharing them.
+			template<typename Allocator>
+			shared_block(shared_block const& other, Allocator const& alloc)
+			: block_{other.block_ ? std::allocate_shared<T>(alloc, T(*other.block_, alloc)) : nullptr} {}
+
+			shared_block(shared_block const&) = default;
+			shared_block(shared_block&&) noexcept = default;
+			auto operator=(shared_block const&) -> shared_block& = default;
+			auto operator=(shared_block&&) noexcept -> shared_block& = default;
+			~shared_block() = default;
+
+			auto operator*() const noexcept -> T const& {
+				return block_ ? *block_ : empty();
+			}
+
+			auto operator->() const noexcept -> T const* {
+				return &**this;
+			}
+
+			// Returns the contents for writing, copying them first if anything else shares them.
+			template<typename Allocator>
+			auto edit(Allocator const& alloc) -> T& {
+				if (!block_) {
+					block_ = std::allocate_shared<T>(alloc, T(alloc));
+				}
+				else if (block_.use_count() != 1) {
+					block_ = std::allocate_shared<T>(alloc, T(*block_, alloc));
+				}
+				else {
+					// Other owners may have let go from other threads; see their reads before
+					// writing.
+					std::atomic_thread_fence(std::memory_order_acquire);
+				}
+				return *block_;
+			}
+
+			auto reset() noexcept -> void {
+				block_.reset();
+			}
+
+		private:
+			static auto empty() noexcept -> T const& {
+				static auto const block = T();
+				return block;
+			}
+
+			std::shared_ptr<T> block_;
+		};
+	} // namespace detail
+
+	/***************************************
+	**                                    **
+	**          Change journal            **
+	**                                    **
+	***************************************/
+	// The changes that took a graph from one version to another, oldest first. Each change is
+	// one successful call of a modifier, and each one moves the version on by one. A delta
+	// doesn't depend on the allocator or lookup policy, so it can be applied to any graph of
+	// the same N and E.
+	template<typename N, typename E>
+	struct delta {
+		struct node_inserted {
+			N value;
+		};
+
+		struct node_erased {
+			N value;
+		};
+
+		struct node_replaced {
+			N old_value;
+			N new_value;
+		};
+
+		struct nodes_merged {
+			N old_value;
+			N new_value;
+		};
+
+		struct edge_inserted {
+			N src;
+			N dst;
+			E weight;
+		};
+
+		struct edge_erased {
+			N src;
+			N dst;
+			E weight;
+		};
+
+		struct cleared {};
+
+		using change = std::variant<node_inserted,
+		                            node_erased,
+		                            node_replaced,
+		                            nodes_merged,
+		                            edge_inserted,
+		                            edge_erased,
+		                            cleared>;
+
+		std::uint64_t from_version = 0;
+		std::uint64_t to_version = 0;
+		std::vector<change> changes;
+	};
+
+	/***************************************
+	**                                    **
+	**          Instrumentation           **
+	**                                    **
+	***************************************/
+	// Define GDWG_GRAPH_STATS before including this header to have every graph count and time
+	// its modifiers and count its comparisons. Without it there is nothing to store or run,
+	// and stats() is always zero.
+
+	// The calls of one modifier. histogram[0] counts calls that took under 1ns and
+	// histogram[b] those that took [2^(b-1), 2^b) ns; the last bucket also takes anything
+	// slower.
+	struct operation_stats {
+		std::uint64_t calls = 0;
+		std::uint64_t total_ns = 0;
+		std::array<std::uint64_t, 40> histogram{};
+	};
+
+	// A snapshot of what one graph has done since it was created or its stats were reset.
+	// A call is counted even if it throws, and erase_edge counts every edge erased, whichever
+	// overload erased it.
+	struct graph_stats {
+#ifdef GDWG_GRAPH_STATS
+		static constexpr bool enabled = true;
+#else
+		static constexpr bool enabled = false;
+#endif
+		operation_stats insert_node;
+		operation_stats insert_edge;
+		operation_stats erase_node;
+		operation_stats erase_edge;
+		operation_stats merge_replace_node;
+		std::uint64_t node_comparisons = 0; // Calls of the node map's comparator
+		std::uint64_t edge_comparisons = 0; // Calls of the edge blocks' comparator
+
+		// Writes each modifier's calls and total time, then one line per non-empty bucket.
+		friend auto operator<<(std::ostream& os, graph_stats const& stats) -> std::ostream& {
+			auto dump = [&os](char const* name, operation_stats const& op) {
+				os << name << ": " << op.calls << " calls, " << op.total_ns << " ns\n";
+				for (auto b = std::size_t{0}; b < op.histogram.size(); ++b) {
+					if (op.histogram[b] != 0) {
+						os << "\t< 2^" << b << " ns: " << op.histogram[b] << "\n";
+					}
+				}
+			};
+			dump("insert_node", stats.insert_node);
+			dump("insert_edge", stats.insert_edge);
+			dump("erase_node", stats.erase_node);
+			dump("erase_edge", stats.erase_edge);
+			dump("merge_replace_node", stats.merge_replace_node);
+			os << "node comparisons: " << stats.node_comparisons << "\n";
+			os << "edge comparisons: " << stats.edge_comparisons << "\n";
+			return os;
+		}
+	};
+
+	namespace detail {
+		enum class operation : std::size_t {
+			insert_node,
+			insert_edge,
+			erase_node,
+			erase_edge,
+			merge_replace_node,
+		};
+
+#ifdef GDWG_GRAPH_STATS
+		// Const calls can compare from several threads at once, so everything is atomic.
+		struct operation_counters {
+			auto add(std::chrono::steady_clock::duration elapsed) noexcept -> void {
+				auto ns = static_cast<std::uint64_t>(
+				   std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+				auto bucket = static_cast<std::size_t>(std::bit_width(ns));
+				bucket = std::min(bucket, histogram.size() - 1);
+				calls.fetch_add(1, std::memory_order_relaxed);
+				total_ns.fetch_add(ns, std::memory_order_relaxed);
+				histogram[bucket].fetch_add(1, std::memory_order_relaxed);
+			}
+
+			auto snapshot() const noexcept -> operation_stats {
+				auto stats = operation_stats{calls.load(std::memory_order_relaxed),
+				                             total_ns.load(std::memory_order_relaxed),
+				                             {}};
+				for (auto b = std::size_t{0}; b < histogram.size(); ++b) {
+					stats.histogram[b] = histogram[b].load(std::memory_order_relaxed);
+				}
+				return stats;
+			}
+
+			auto reset() noexcept -> void {
+				calls.store(0, std::memory_order_relaxed);
+				total_ns.store(0, std::memory_order_relaxed);
+				for (auto& bucket : histogram) {
+					bucket.store(0, std::memory_order_relaxed);
+				}
+			}
+
+			std::atomic<std::uint64_t> calls{0};
+			std::atomic<std::uint64_t> total_ns{0};
+			std::array<std::atomic<std::uint64_t>, operation_stats{}.histogram.size()> histogram{};
+		};
+
+		struct graph_counters {
+			auto snapshot() const noexcept -> graph_stats {
+				auto stats = graph_stats{};
+				stats.insert_node = of(operation::insert_node).snapshot();
+				stats.insert_edge = of(operation::insert_edge).snapshot();
+				stats.erase_node = of(operation::erase_node).snapshot();
+				stats.erase_edge = of(operation::erase_edge).snapshot();
+				stats.merge_replace_node = of(operation::merge_replace_node).snapshot();
+				stats.node_comparisons = node_comparisons.load(std::memory_order_relaxed);
+				stats.edge_comparisons = edge_comparisons.load(std::memory_order_relaxed);
+				return stats;
+			}
+
+			auto reset() noexcept -> void {
+				for (auto& op : operations) {
+					op.reset();
+				}
+				node_comparisons.store(0, std::memory_order_relaxed);
+				edge_comparisons.store(0, std::memory_order_relaxed);
+			}
+
+			auto of(operation op) noexcept -> operation_counters& {
+				return operations[static_cast<std::size_t>(op)];
+			}
+
+			auto of(operation op) const noexcept -> operation_counters const& {
+				return operations[static_cast<std::size_t>(op)];
+			}
+
+			std::array<operation_counters, 5> operations;
+			std::atomic<std::uint64_t> node_comparisons{0};
+			std::atomic<std::uint64_t> edge_comparisons{0};
+		};
+
+		// Adds the time from its construction to its destruction to counters.
+		class operation_timer {
+		public:
+			explicit operation_timer(operation_counters& counters) noexcept
+			: counters_{counters}
+			, start_{std::chrono::steady_clock::now()} {}
+
+			operation_timer(operation_timer const&) = delete;
+			auto operator=(operation_timer const&) -> operation_timer& = delete;
+
+			~operation_timer() {
+				counters_.add(std::chrono::steady_clock::now() - start_);
+			}
+
+		private:
+			operation_counters& counters_;
+			std::chrono::steady_clock::time_point start_;
+		};
+#else
+		// What the modifiers time themselves with when GDWG_GRAPH_STATS isn't defined.
+		struct operation_timer {};
+#endif
+	} // namespace detail
+
+	// Every node, edge and index entry is allocated through Allocator (rebound as needed), so a
+	// graph can be built inside a pool or monotonic arena and dropped with it.
+	// Lookup is ordered_lookup or hashed_lookup; see above.
+	template<typename N,
+	         typename E,
+	         typename Allocator = std::allocator<N>,
+	         typename Lookup = ordered_lookup>
 	class graph {
+		template<typename T>
+		using rebind_alloc = typename std::allocator_traits<Allocator>::template rebind_alloc<T>;
+
 	public:
+		using allocator_type = Allocator;
+
+		// Every node is interned once and given a dense ID that stays the same for as long as
+		// the node is in the graph. IDs of erased nodes are handed out again to new nodes.
+		// This is its own type so the ID overloads never clash with N, even when N is an integer.
+		enum class id_type : std::uint32_t {};
+
+		/***************************************
+		**                                    **
+		**       Transparent Comparators      **
+		**                                    **
+		***************************************/
+		// An edge is its destination's ID and its weight. It holds no reference to the node, so
+		// reading or copying edges never touches a reference count; the map's keys own the nodes.
+		// It is a plain aggregate, because std::pair's assignment operators keep it from being
+		// trivially copyable. With a trivially copyable E, edge blocks are shifted with memmove.
+		struct edgePair {
+			id_type first;
+			E second;
+		};
+		static_assert(sizeof(id_type) == sizeof(std::uint32_t));
+
+		// ID -> node value table read by setComparator.
+		using node_table = std::vector<N const*, rebind_alloc<N const*>>;
+
+		struct mapComparator {
+			using is_transparent = void;
+			// this overload will sort the source nodes of the map in increasing order.
+			bool operator()(std::shared_ptr<N> const& a, std::shared_ptr<N> const& b) const {
+				count();
+				return *a < *b;
+			}
+			// this overload is used when the map.find(something) is called.
+			// comparator made for both lhs and rhs cases.
+			auto operator()(std::shared_ptr<N> const& a, N const& b) const noexcept -> bool {
+				count();
+				return *a < b;
+			}
+			auto operator()(N const& a, std::shared_ptr<N> const& b) const noexcept -> bool {
+				count();
+				return a < *b;
+			}
+
+			auto count() const noexcept -> void {
+#ifdef GDWG_GRAPH_STATS
+				if (stats) {
+					stats->node_comparisons.fetch_add(1, std::memory_order_relaxed);
+				}
+#endif
+			}
+
+#ifdef GDWG_GRAPH_STATS
+			// Shared with the owning graph. A moved-from comparator may be left without any.
+			std::shared_ptr<detail::graph_counters> stats;
+#endif
+		};
+
+		// Orders the edges leaving a node. The blocks don't keep one, so every search makes one
+		// from the graph's ID table.
+		struct setComparator {
+			using is_transparent = void;
+			// This overload will sort the destination node(edges) in increasing order.
+			// If the destination node is the same then it is sorted by weight "E"
+			// Equal IDs mean the same node, so the node values only get compared when they differ.
+			bool operator()(edgePair const& a, edgePair const& b) const {
+				count();
+				if (a.first == b.first) {
+					return a.second < b.second;
+				}
+				return value(a.first) < value(b.first);
+			}
+			// These overloads are used to look up every edge going to one destination ID.
+			auto operator()(edgePair const& a, id_type b) const noexcept -> bool {
+				count();
+				return a.first != b && value(a.first) < value(b);
+			}
+			auto operator()(id_type a, edgePair const& b) const noexcept -> bool {
+				count();
+				return a != b.first && value(a) < value(b.first);
+			}
+			// This overload is used when set.find() is used.
+			// Comparator made for both lhs and rhs cases.
+			auto operator()(edgePair const& a, N const& b) const noexcept -> bool {
+				count();
+				return value(a.first) < b;
+			}
+			auto operator()(N const& a, edgePair const& b) const noexcept -> bool {
+				count();
+				return a < value(b.first);
+			}
+
+			// Look up the node value behind an ID.
+			auto value(id_type id) const noexcept -> N const& {
+				return *((*nodes)[static_cast<std::size_t>(id)]);
+			}
+
+			auto count() const noexcept -> void {
+#ifdef GDWG_GRAPH_STATS
+				if (stats) {
+					stats->edge_comparisons.fetch_add(1, std::memory_order_relaxed);
+				}
+#endif
+			}
+
+			node_table const* nodes = nullptr; // The owning graph's ID table
+#ifdef GDWG_GRAPH_STATS
+			detail::graph_counters* stats = nullptr;
+#endif
+		};
+
+		// The edges leaving a node, sorted by setComparator. They sit in one contiguous block that
+		// copies of the graph share until one of them changes it. The first few live inside the
+		// block itself, so a low degree node costs one allocation for all of its edges.
+		using destination_node = detail::small_vector<edgePair, detail::inline_edges, rebind_alloc<edgePair>>;
+
+		// Reverse index: source ID -> number of edges from that source into a node.
+		using incoming_map =
+		   std::map<id_type, std::size_t, std::less<>, rebind_alloc<std::pair<id_type const, std::size_t>>>;
+
+		// Everything the map stores about a source node. Both indexes are shared with copies of
+		// the graph until one side changes them.
+		struct node_entry {
+			id_type id;
+			detail::shared_block<destination_node> edges;
+			detail::shared_block<incoming_map> incoming;
+		};
+
+		using node_map = std::map<std::shared_ptr<N>,
+		                          node_entry,
+		                          mapComparator,
+		                          rebind_alloc<std::pair<std::shared_ptr<N> const, node_entry>>>;
+
+		/***************************************
+		**                                    **
+		**          Custom Iterator           **
+		**                                    **
+		***************************************/
+		struct value_type {
+			N from;
+			N to;
+			E weight;
+		};
+
+		// What a bulk insert did with its batch of edges.
+		struct bulk_insert_result {
+			std::size_t inserted = 0; // Edges that were not in the graph before
+			std::size_t duplicates = 0; // Edges already in the graph or repeated in the batch
+		};
+
+		// An edge that refers straight into the graph instead of copying it.
+		using edge_reference = std::tuple<N const&, N const&, E const&>;
+
+		// Copying selects what dereferencing gives back: a value_type copy of the edge, or an
+		// edge_reference into the graph. Both walk the edges in the same order.
+		template<bool Copying>
+		class basic_iterator {
+			using outer_iterator = typename node_map::const_iterator;
+			using inner_iterator = typename destination_node::const_iterator;
+
+		public:
+			using value_type = std::conditional_t<Copying, graph::value_type, std::tuple<N, N, E>>;
+			using reference = std::conditional_t<Copying, value_type, edge_reference>;
+			using pointer = void;
+			using difference_type = std::ptrdiff_t;
+			using iterator_category = std::bidirectional_iterator_tag;
+
+			basic_iterator(const outer_iterator& curr,
+			               const outer_iterator& end,
+			               const inner_iterator& pos,
+			               node_table const* nodes = nullptr)
+			: curr_{curr}
+			, end_{end}
+			, pos_{pos}
+			, nodes_{nodes} {};
+
+			auto operator*() const noexcept(!Copying) -> reference {
+				auto const& to = *(*nodes_)[static_cast<std::size_t>(pos_->first)];
+				if constexpr (Copying) {
+					return value_type{*(curr_->first), to, pos_->second};
+				}
+				else {
+					return edge_reference{*(curr_->first), to, pos_->second};
+				}
+			}
+
+			// pre increment
+			auto operator++() noexcept -> basic_iterator& {
+				if (curr_ != end_) {
+					pos_++;
+					if (pos_ == (curr_->second.edges->end())) {
+						curr_++;
+						while (curr_ != end_) {
+							if (!curr_->second.edges->empty()) {
+								pos_ = curr_->second.edges->begin();
+								return *this;
+							}
+							curr_++;
+						}
+					}
+				}
+				return *this;
+			}
+
+			// post increment... strapped to pre increment.
+			auto operator++(int) noexcept -> basic_iterator {
+				auto temp = *this;
+				++(*this);
+				return temp;
+			}
+
+			// pre decrement
+			auto operator--() noexcept -> basic_iterator& {
+				if (curr_ == end_) {
+					--curr_;
+					while (curr_->second.edges->empty()) {
+						--curr_;
+					}
+					pos_ = curr_->second.edges->cend();
+					pos_--;
+					return *this;
+				}
+				while (pos_ == curr_->second.edges->cbegin()) {
+					curr_--;
+					pos_ = curr_->second.edges->cend();
+				}
+				--pos_;
+				return *this;
+			}
+
+			// post decrement
+			auto operator--(int) noexcept -> basic_iterator {
+				auto temp = *this;
+				--(*this);
+				return temp;
+			}
+
+			// Iterator comparison
+			auto operator==(basic_iterator const& other) const -> bool {
+				if (other.curr_ == other.end_ || curr_ == end_) {
+					return (other.curr_ == curr_);
+				}
+				else {
+					return ((other.pos_ == pos_) && (other.curr_ == curr_));
+				}
+			}
+
+		private:
+			friend class graph;
+			outer_iterator curr_; // Current graph iterator
+			outer_iterator end_; // End iterator
+			inner_iterator pos_; // Position of inner iterator
+			node_table const* nodes_; // The graph's ID table, to look up destinations
+		};
+
+		// Copies each edge into a value_type.
+		using iterator = basic_iterator<true>;
+		// Hands out edge_references, so walking the graph copies nothing.
+		using edge_iterator = basic_iterator<false>;
+
+		// A range over every edge as an edge_reference.
+		class edge_view {
+		public:
+			edge_view(edge_iterator first, edge_iterator last)
+			: first_{first}
+			, last_{last} {}
+
+			[[nodiscard]] auto begin() const -> edge_iterator {
+				return first_;
+			}
+
+			[[nodiscard]] auto end() const -> edge_iterator {
+				return last_;
+			}
+
+		private:
+			edge_iterator first_;
+			edge_iterator last_;
+		};
+
+		// Walks a stretch of the map or of one edge set, handing out project(element). With
+		// SkipRepeats it steps over edges to the same destination, so each one is seen once.
+		template<typename BaseIt, typename Project, bool SkipRepeats = false>
+		class projected_iterator {
+		public:
+			using reference = std::invoke_result_t<Project const&, typename std::iterator_traits<BaseIt>::reference>;
+			using value_type = std::remove_cvref_t<reference>;
+			using pointer = void;
+			using difference_type = std::ptrdiff_t;
+			using iterator_category = std::forward_iterator_tag;
+
+			projected_iterator() = default;
+
+			projected_iterator(BaseIt pos, BaseIt end, Project project)
+			: pos_{pos}
+			, end_{end}
+			, project_{project} {}
+
+			auto operator*() const -> reference {
+				return project_(*pos_);
+			}
+
+			auto operator++() -> projected_iterator& {
+				if constexpr (SkipRepeats) {
+					auto id = pos_->first;
+					do {
+						++pos_;
+					} while (pos_ != end_ && pos_->first == id);
+				}
+				else {
+					++pos_;
+				}
+				return *this;
+			}
+
+			auto operator++(int) -> projected_iterator {
+				auto temp = *this;
+				++(*this);
+				return temp;
+			}
+
+			auto operator==(projected_iterator const& other) const -> bool {
+				return pos_ == other.pos_;
+			}
+
+		private:
+			BaseIt pos_;
+			BaseIt end_;
+			Project project_;
+		};
+
+		// A non-owning range over part of the graph. It stays valid until the part it covers is
+		// modified.
+		template<typename It>
+		class range_view {
+		public:
+			using iterator_type = It;
+
+			range_view(It first, It last)
+			: first_{first}
+			, last_{last} {}
+
+			[[nodiscard]] auto begin() const -> It {
+				return first_;
+			}
+
+			[[nodiscard]] auto end() const -> It {
+				return last_;
+			}
+
+			[[nodiscard]] auto empty() const -> bool {
+				return first_ == last_;
+			}
+
+		private:
+			It first_;
+			It last_;
+		};
+
+		// Projections used by the views below.
+		struct project_node {
+			auto operator()(typename node_map::value_type const& entry) const -> N const& {
+				return *entry.first;
+			}
+		};
+
+		struct project_destination {
+			auto operator()(edgePair const& edge) const -> N const& {
+				return *(*nodes)[static_cast<std::size_t>(edge.first)];
+			}
+
+			node_table const* nodes = nullptr;
+		};
+
+		struct project_edge {
+			auto operator()(edgePair const& edge) const -> std::pair<N const&, E const&> {
+				return {*(*nodes)[static_cast<std::size_t>(edge.first)], edge.second};
+			}
+
+			node_table const* nodes = nullptr;
+		};
+
+		struct project_weight {
+			auto operator()(edgePair const& edge) const -> E const& {
+				return edge.second;
+			}
+		};
+
+		using edge_set_iterator = typename destination_node::const_iterator;
+		// Every node, in order.
+		using node_view =
+		   range_view<projected_iterator<typename node_map::const_iterator, project_node>>;
+		// The (dst, weight) pairs of the edges leaving a node, in iteration order.
+		using out_edge_view = range_view<projected_iterator<edge_set_iterator, project_edge>>;
+		// Each node an edge leaves a node for, once, in order.
+		using neighbor_view =
+		   range_view<projected_iterator<edge_set_iterator, project_destination, true>>;
+		// The weights of the edges from one node to another, in order.
+		using weight_view = range_view<projected_iterator<edge_set_iterator, project_weight>>;
+
+		// The edge predicate of a filter_view that leaves it out: every edge is kept.
+		struct keep_edges {
+			auto operator()(N const&, N const&, E const&) const noexcept -> bool {
+				return true;
+			}
+		};
+
+		// The node predicate of a subgraph: one flag per node ID.
+		struct keep_ids {
+			auto operator()(id_type id) const noexcept -> bool {
+				return keep[static_cast<std::size_t>(id)];
+			}
+
+			std::vector<bool> keep;
+		};
+
+		// A lazy view of the nodes keep_node accepts and of the edges between them that keep_edge
+		// accepts. It walks the graph's own storage, so making one copies nothing, and it stays
+		// valid until the graph is modified. keep_node takes a node's value, or failing that its
+		// ID; keep_edge takes (src, dst, weight).
+		template<typename NodePred, typename EdgePred>
+		class filtered_view {
+		public:
+			// Walks the kept edges in iteration order, handing out edge_references.
+			class iterator {
+				using outer_iterator = typename node_map::const_iterator;
+				using inner_iterator = typename destination_node::const_iterator;
+
+			public:
+				using value_type = std::tuple<N, N, E>;
+				using reference = edge_reference;
+				using pointer = void;
+				using difference_type = std::ptrdiff_t;
+				using iterator_category = std::forward_iterator_tag;
+
+				iterator() = default;
+
+				auto operator*() const -> reference {
+					return edge_reference{*(curr_->first), view_->value(pos_->first), pos_->second};
+				}
+
+				auto operator++() -> iterator& {
+					++pos_;
+					settle();
+					return *this;
+				}
+
+				auto operator++(int) -> iterator {
+					auto temp = *this;
+					++(*this);
+					return temp;
+				}
+
+				auto operator==(iterator const& other) const -> bool {
+					return curr_ == other.curr_ && (curr_ == end_ || pos_ == other.pos_);
+				}
+
+			private:
+				friend class filtered_view;
+
+				iterator(filtered_view const* view, outer_iterator curr)
+				: view_{view}
+				, curr_{curr}
+				, end_{view->graph_->graph_.end()} {
+					if (curr_ != end_) {
+						pos_ = curr_->second.edges->begin();
+					}
+					settle();
+				}
+
+				// Moves on to the first kept edge at or after pos_.
+				auto settle() -> void {
+					while (curr_ != end_) {
+						if (view_->keeps(curr_->second.id)) {
+							auto const& edges = *curr_->second.edges;
+							for (; pos_ != edges.end(); ++pos_) {
+								if (view_->keeps(*curr_, *pos_)) {
+									return;
+								}
+							}
+						}
+						if (++curr_ != end_) {
+							pos_ = curr_->second.edges->begin();
+						}
+					}
+				}
+
+				filtered_view const* view_ = nullptr;
+				outer_iterator curr_;
+				outer_iterator end_;
+				inner_iterator pos_;
+			};
+
+			[[nodiscard]] auto begin() const -> iterator {
+				return iterator(this, graph_->graph_.begin());
+			}
+
+			[[nodiscard]] auto end() const -> iterator {
+				return iterator(this, graph_->graph_.end());
+			}
+
+			// This function tells us if value is a node of the view.
+			[[nodiscard]] auto is_node(N const& value) const -> bool {
+				auto i = graph_->locate(value);
+				return i != graph_->graph_.end() && keeps(i->second.id);
+			}
+
+			// This function returns the nodes of the view, in order.
+			[[nodiscard]] auto nodes() const -> std::vector<N> {
+				auto v = std::vector<N>{};
+				for (auto const& [value, entry] : graph_->graph_) {
+					if (keeps(entry.id)) {
+						v.push_back(*value);
+					}
+				}
+				return v;
+			}
+
+			// This function builds a standalone graph of what the view shows, in one pass over
+			// the nodes and one over their edges. The kept nodes get fresh dense IDs in order
+			// and share their values with the parent like a copy does. Dropping nodes keeps
+			// the edges in order, so each block is filled by appending.
+			[[nodiscard]] auto materialize() const -> graph {
+				auto const& from = *graph_;
+				auto g = graph(from.alloc_);
+				g.node_values_ = std::make_unique<node_table>(g.alloc_);
+				auto renumber = std::vector<id_type>(from.ids_.size());
+				for (auto i = from.graph_.begin(); i != from.graph_.end(); ++i) {
+					if (!keeps(i->second.id)) {
+						continue;
+					}
+					auto id = static_cast<id_type>(g.ids_.size());
+					renumber[index(i->second.id)] = id;
+					g.node_values_->push_back(i->first.get());
+					g.ids_.push_back(g.graph_.emplace_hint(g.graph_.end(), i->first, node_entry{id, {}, {}}));
+					g.lookup_.insert_node(*(i->first), raw_id(id), *g.node_values_);
+				}
+				for (auto i = from.graph_.begin(); i != from.graph_.end(); ++i) {
+					if (!keeps(i->second.id)) {
+						continue;
+					}
+					auto src = renumber[index(i->second.id)];
+					auto* block = static_cast<destination_node*>(nullptr);
+					for (auto const& edge : *i->second.edges) {
+						if (!keeps(*i, edge)) {
+							continue;
+						}
+						if (block == nullptr) {
+							block = &g.ids_[index(src)]->second.edges.edit(g.alloc_);
+						}
+						auto dst = renumber[index(edge.first)];
+						block->insert(block->end(), edgePair{dst, edge.second});
+						++g.ids_[index(dst)]->second.incoming.edit(g.alloc_)[src];
+						g.lookup_.add_edges(raw_id(src), raw_id(dst), 1);
+					}
+				}
+				return g;
+			}
+
+		private:
+			friend class graph;
+
+			filtered_view(graph const* g, NodePred keep_node, EdgePred keep_edge)
+			: graph_{g}
+			, keep_node_{std::move(keep_node)}
+			, keep_edge_{std::move(keep_edge)} {}
+
+			auto value(id_type id) const -> N const& {
+				return *(*graph_->node_values_)[index(id)];
+			}
+
+			auto keeps(id_type id) const -> bool {
+				if constexpr (std::is_invocable_r_v<bool, NodePred const&, N const&>) {
+					return keep_node_(value(id));
+				}
+				else {
+					return keep_node_(id);
+				}
+			}
+
+			// Whether the edge of src is kept: both its ends and the edge itself must be.
+			auto keeps(typename node_map::value_type const& src, edgePair const& edge) const -> bool {
+				return keeps(edge.first) && keep_edge_(*(src.first), value(edge.first), edge.second);
+			}
+
+			graph const* graph_;
+			NodePred keep_node_;
+			EdgePred keep_edge_;
+		};
+
+		[[nodiscard]] auto begin() const -> iterator {
+			return first_edge<iterator>();
+		}
+
+		[[nodiscard]] auto end() const -> iterator {
+			return edge_at<iterator>(graph_.end(), 0);
+		}
+
+		// Every edge in iteration order, without copying any nodes or weights.
+		[[nodiscard]] auto edges() const -> edge_view {
+			return edge_view{first_edge<edge_iterator>(), edge_at<edge_iterator>(graph_.end(), 0)};
+		}
+
+		// This function returns a lazy view of the nodes keep_node accepts and the edges between
+		// them that keep_edge accepts. Call materialize() on it for a graph of its own.
+		template<typename NodePred, typename EdgePred = keep_edges>
+		[[nodiscard]] auto filter_view(NodePred keep_node, EdgePred keep_edge = {}) const
+		   -> filtered_view<NodePred, EdgePred> {
+			return filtered_view<NodePred, EdgePred>(this, std::move(keep_node), std::move(keep_edge));
+		}
+
+		// This function returns a lazy view of the subgraph induced by nodes: those nodes and
+		// every edge between two of them.
+		template<typename Range>
+		[[nodiscard]] auto subgraph(Range const& nodes) const -> filtered_view<keep_ids, keep_edges> {
+			auto keep = std::vector<bool>(ids_.size());
+			for (auto const& value : nodes) {
+				auto i = locate(value);
+				if (i == graph_.end()) {
+					throw std::runtime_error("Cannot call gdwg::graph<N, E>::subgraph if a node doesn't"
+					                         " exist in the graph");
+				}
+				keep[index(i->second.id)] = true;
+			}
+			return filter_view(keep_ids{std::move(keep)});
+		}
+
+		[[nodiscard]] auto subgraph(std::initializer_list<N> nodes) const
+		   -> filtered_view<keep_ids, keep_edges> {
+			return subgraph<std::initializer_list<N>>(nodes);
+		}
+
+		/***************************************
+		**                                    **
+		**           constructors             **
+		**                                    **
+		***************************************/
+
+		// Default constructor to create an empty map.
+		graph() noexcept(noexcept(Allocator()))
+		: graph(Allocator()) {}
+
+		// Create an empty graph that allocates everything through alloc.
+		explicit graph(Allocator const& alloc) noexcept
+		: graph_(node_order(), alloc)
+		, ids_(alloc)
+		, free_ids_(alloc)
+		, lookup_(alloc)
+		, alloc_{alloc} {}
+
+		// Create a graph using nodes from an initialiser list.
+		graph(std::initializer_list<N> il, Allocator const& alloc = Allocator())
+		: graph(alloc) {
+			for (auto i = il.begin(); i != il.end(); ++i) {
+				insert_node(*i);
+			}
+		}
+
+		// Creating a graph given all the start and end iter of an abject.
+		template<typename InputIt>
+		graph(InputIt first, InputIt last, Allocator const& alloc = Allocator())
+		: graph(alloc) {
+			for (auto i = first; i != last; ++i) {
+				insert_node(*i);
+			}
+		}
+
+		// Create a graph from a range of edges. Every node an edge mentions is created too.
+		template<typename InputIt>
+		requires std::same_as<typename std::iterator_traits<InputIt>::value_type, value_type>
+		graph(InputIt first, InputIt last, Allocator const& alloc = Allocator())
+		: graph(alloc) {
+			auto batch = std::vector<value_type>(first, last);
+			sort_batch(batch);
+			for (auto i = batch.begin(); i != batch.end(); ++i) {
+				insert_node(i->from);
+				insert_node(i->to);
+			}
+			insert_sorted_edges(batch);
+		}
+
+		// Move constructor to create the graph. The counters are taken from the map's comparator
+		// rather than moved, so other keeps a share of them too.
+		graph(graph&& other) noexcept
+		: graph_(std::move(other.graph_))
+		, node_values_(std::move(other.node_values_))
+		, ids_(std::move(other.ids_))
+		, free_ids_(std::move(other.free_ids_))
+		, lookup_(std::move(other.lookup_))
+		, alloc_(std::move(other.alloc_))
+		, journal_(std::move(other.journal_))
+		, version_{other.version_} {}
+
+		// Move operator to move-assign all the nodes of an old graph.
+		auto operator=(graph&& other) noexcept(
+		   std::allocator_traits<Allocator>::propagate_on_container_move_assignment::value
+		   || std::allocator_traits<Allocator>::is_always_equal::value) -> graph& {
+			if constexpr (!std::allocator_traits<Allocator>::propagate_on_container_move_assignment::value
+			              && !std::allocator_traits<Allocator>::is_always_equal::value)
+			{
+				// Nodes can't move between allocators that don't compare equal, so copy them into
+				// our own storage instead.
+				if (alloc_ != other.alloc_) {
+					return *this = graph(other, alloc_);
+				}
+			}
+			graph_ = std::move(other.graph_);
+			node_values_ = std::move(other.node_values_);
+			ids_ = std::move(other.ids_);
+			free_ids_ = std::move(other.free_ids_);
+			lookup_ = std::move(other.lookup_);
+			journal_ = std::move(other.journal_);
+			version_ = other.version_;
+#ifdef GDWG_GRAPH_STATS
+			stats_ = other.stats_;
+#endif
+			if constexpr (std::allocator_traits<Allocator>::propagate_on_container_move_assignment::value) {
+				alloc_ = std::move(other.alloc_);
+			}
+			return *this;
+		}
+
+		// Copy constructor to copy the whole old graph.
+		graph(graph const& other)
+		: graph(other,
+		        std::allocator_traits<Allocator>::select_on_container_copy_construction(other.alloc_)) {}
+
+		// Copy the whole old graph into storage from alloc. When alloc is the allocator of other,
+		// the node values and edge blocks are shared rather than copied. Whichever graph changes
+		// a shared block first takes its own copy of just that block. Copies are O(V), not O(1):
+		// a copy builds one map entry and one ID table slot per node. Under ordered_lookup
+		// nothing is copied per edge. Under hashed_lookup the hash index is copied too, and it
+		// holds a count per connected (src, dst) pair, so a hashed copy is O(V + P), where P is
+		// the number of distinct pairs. A journaling graph's copy journals too, but starts with
+		// no changes at the version it was copied at, so its cost doesn't grow with the history.
+		graph(graph const& other, Allocator const& alloc)
+		: graph_(node_order(), alloc)
+		, node_values_{std::make_unique<node_table>(other.ids_.size(), alloc)}
+		, ids_(other.ids_.size(), alloc)
+		, free_ids_(other.free_ids_, alloc)
+		, lookup_(other.lookup_, alloc)
+		, alloc_{alloc}
+		, journal_{other.journal_ ? std::make_unique<journal>(other.version_, alloc) : nullptr}
+		, version_{other.version_} {
+			// Every node keeps its ID so the edges can be used as they are. The map is already
+			// sorted, so each node goes in at the end.
+			auto share = alloc_ == other.alloc_;
+			for (auto i = other.graph_.begin(); i != other.graph_.end(); ++i) {
+				auto value = share ? i->first : std::allocate_shared<N>(alloc_, *(i->first));
+				auto entry = share ? i->second
+				                   : node_entry{i->second.id,
+				                                {i->second.edges, alloc_},
+				                                {i->second.incoming, alloc_}};
+				(*node_values_)[index(entry.id)] = value.get();
+				ids_[index(entry.id)] = graph_.emplace_hint(graph_.end(), std::move(value), std::move(entry));
+			}
+		}
+
+		/***************************************
+		**                                    **
+		**            modifiers               **
+		**                                    **
+		***************************************/
+
+		// This function iserts a source node.
+		auto insert_node(N const& value) -> bool {
+			[[maybe_unused]] auto const timer = timed(detail::operation::insert_node);
+			auto exist = locate(value);
+			if (exist == graph_.end()) {
+				if (!node_values_) {
+					node_values_ = std::make_unique<node_table>(alloc_);
+				}
+				// Reuse the ID of an erased node before growing the ID table.
+				auto id = id_type{};
+				if (free_ids_.empty()) {
+					id = static_cast<id_type>(ids_.size());
+					ids_.emplace_back();
+					node_values_->emplace_back();
+				}
+				else {
+					id = free_ids_.back();
+					free_ids_.pop_back();
+				}
+				add_node(std::allocate_shared<N>(alloc_, value), id);
+				lookup_.insert_node(value, raw_id(id), *node_values_);
+				record<node_inserted>(value);
+				return true;
+			}
+			return false;
+		}
+
+		// This function inserts a new edge that is not in the graph.
+		auto insert_edge(N const& src, N const& dst, E const& weight) -> bool {
+			[[maybe_unused]] auto const timer = timed(detail::operation::insert_edge);
+			// sNode is the set of edges going from src.
+			auto sNode = locate(src);
+			auto dNode = locate(dst);
+			if (sNode == graph_.end() || dNode == graph_.end()) {
+				throw std::runtime_error("Cannot call gdwg::graph<N, E>::insert_edge when either "
+				                         "src or dst node does not exist");
+			}
+			if (!add_edge(sNode->second, dNode->second, weight)) {
+				return false;
+			}
+			record<edge_inserted>(src, dst, weight);
+			return true;
+		}
+
+		// This function inserts a new edge between two interned node IDs.
+		auto insert_edge(id_type src, id_type dst, E const& weight) -> bool {
+			[[maybe_unused]] auto const timer = timed(detail::operation::insert_edge);
+			if (!is_node(src) || !is_node(dst)) {
+				throw std::runtime_error("Cannot call gdwg::graph<N, E>::insert_edge when either "
+				                         "src or dst node does not exist");
+			}
+			if (!add_edge(ids_[index(src)]->second, ids_[index(dst)]->second, weight)) {
+				return false;
+			}
+			record<edge_inserted>(node(src), node(dst), weight);
+			return true;
+		}
+
+		// This function inserts a whole batch of edges at once.
+		// The batch is sorted and deduplicated first, so each source and destination is only
+		// looked up once and the edges go into each set in order. Nothing is inserted if any
+		// edge mentions a node that does not exist.
+		template<typename InputIt>
+		auto insert_edges(InputIt first, InputIt last) -> bulk_insert_result {
+			auto batch = std::vector<value_type>(first, last);
+			auto total = batch.size();
+			sort_batch(batch);
+			auto result = insert_sorted_edges(batch);
+			result.duplicates += total - batch.size();
+			return result;
+		}
+
+		// This function inserts a batch of edges leaving the interned node src, given as
+		// (destination ID, weight) pairs. A batch already in iteration order isn't sorted again,
+		// and when src has no edges yet the whole batch is appended to its block at once, with
+		// one reverse index update per destination. Nothing is inserted if any ID is not a node.
+		template<typename InputIt>
+		auto insert_edges(id_type src, InputIt first, InputIt last) -> bulk_insert_result {
+			auto batch = std::vector<edgePair>{};
+			for (; first != last; ++first) {
+				auto const& [dst, weight] = *first;
+				batch.push_back(edgePair{dst, weight});
+			}
+			auto const total = batch.size();
+			if (!is_node(src)
+			    || !std::all_of(batch.begin(), batch.end(), [this](edgePair const& e) { return is_node(e.first); }))
+			{
+				throw std::runtime_error("Cannot call gdwg::graph<N, E>::insert_edges when either "
+				                         "src or dst node does not exist");
+			}
+			auto order = edge_order();
+			if (!std::is_sorted(batch.begin(), batch.end(), order)) {
+				std::sort(batch.begin(), batch.end(), order);
+			}
+			batch.erase(std::unique(batch.begin(),
+			                        batch.end(),
+			                        [&order](edgePair const& a, edgePair const& b) { return !order(a, b); }),
+			            batch.end());
+			auto result = bulk_insert_result{};
+			auto& entry = ids_[index(src)]->second;
+			if (!entry.edges->empty()) {
+				// Some of the batch may already be there, so each edge is searched for.
+				for (auto const& edge : batch) {
+					if (add_edge(entry, ids_[index(edge.first)]->second, edge.second)) {
+						record<edge_inserted>(node(src), node(edge.first), edge.second);
+						++result.inserted;
+					}
+				}
+				result.duplicates = total - result.inserted;
+				return result;
+			}
+			if (batch.empty()) {
+				return result;
+			}
+			auto& block = entry.edges.edit(alloc_);
+			block.insert(block.end(), batch.begin(), batch.end());
+			for (auto run = batch.begin(); run != batch.end();) {
+				auto dst = run->first;
+				auto next = std::find_if(run, batch.end(), [dst](edgePair const& e) { return e.first != dst; });
+				auto count = static_cast<std::size_t>(next - run);
+				ids_[index(dst)]->second.incoming.edit(alloc_)[src] += count;
+				lookup_.add_edges(raw_id(src), raw_id(dst), count);
+				run = next;
+			}
+			for (auto const& edge : batch) {
+				record<edge_inserted>(node(src), node(edge.first), edge.second);
+			}
+			result.inserted = batch.size();
+			result.duplicates = total - batch.size();
+			return result;
+		}
+
+		auto replace_node(N const& old_data, N const& new_data) -> bool {
+			if (!is_node(old_data)) {
+				throw std::runtime_error("Cannot call gdwg::graph<N, E>::replace_node on a node "
+				                         "that doesn't exist");
+			}
+			if (is_node(new_data)) {
+				return false;
+			}
+			// Get the key corresponding to old data
+			auto entry = locate(old_data);
+			auto id = entry->second.id;
+			// Everything that can throw happens before the graph changes, so a failure leaves
+			// it as it was. That takes N's comparisons and E's swap not throwing, as elsewhere.
+			// Edges into the node are sorted by its value, so note where each source keeps them
+			// while the old value still finds them. Each source's block is made this graph's
+			// own now, so rotating the edges later doesn't have to copy it.
+			auto runs = std::vector<std::pair<id_type, std::pair<std::size_t, std::size_t>>>{};
+			runs.reserve(entry->second.incoming->size());
+			for (auto i = entry->second.incoming->begin(); i != entry->second.incoming->end(); ++i) {
+				auto const& edges = ids_[index(i->first)]->second.edges.edit(alloc_);
+				auto [first, last] = std::equal_range(edges.begin(), edges.end(), id, edge_order());
+				runs.emplace_back(i->first,
+				                  std::pair{static_cast<std::size_t>(first - edges.begin()),
+				                            static_cast<std::size_t>(last - edges.begin())});
+			}
+			// The node value is overwritten in place if no copy of the graph shares it, and if
+			// moving a copy of new_data into it can't throw. Otherwise it is replaced.
+			auto value = std::optional<N>{};
+			auto replacement = std::shared_ptr<N>{};
+			if (entry->first.use_count() == 1 && std::is_nothrow_move_assignable_v<N>) {
+				std::atomic_thread_fence(std::memory_order_acquire);
+				value.emplace(new_data);
+			}
+			else {
+				replacement = std::allocate_shared<N>(alloc_, new_data);
+			}
+			lookup_.rename_node(old_data, new_data, raw_id(id));
+			// Re-key the map entry through its node handle. The edge blocks and the ID go with it,
+			// so nothing that refers to the node by ID has to change.
+			auto handle = graph_.extract(entry);
+			if (value) {
+				*handle.key() = std::move(*value);
+			}
+			else {
+				handle.key() = std::move(replacement);
+				(*node_values_)[index(id)] = handle.key().get();
+			}
+			ids_[index(id)] = graph_.insert(std::move(handle)).position;
+			// Rotate each run of edges into the node to where the new value sorts. The rest of
+			// the block is still sorted, so the new place is found on one side of the run.
+			for (auto const& [src, run] : runs) {
+				auto& edges = ids_[index(src)]->second.edges.edit(alloc_);
+				auto first = edges.begin() + static_cast<std::ptrdiff_t>(run.first);
+				auto last = edges.begin() + static_cast<std::ptrdiff_t>(run.second);
+				if (old_data < new_data) {
+					std::rotate(first, last, std::lower_bound(last, edges.end(), id, edge_order()));
+				}
+				else {
+					std::rotate(std::lower_bound(edges.begin(), first, id, edge_order()), first, last);
+				}
+			}
+			record<node_replaced>(old_data, new_data);
+			return true;
+		}
+
+		auto merge_replace_node(N const& old_data, N const& new_data) -> void {
+			[[maybe_unused]] auto const timer = timed(detail::operation::merge_replace_node);
+			if (!is_node(old_data) || !is_node(new_data)) {
+				throw std::runtime_error("Cannot call gdwg::graph<N, E>::merge_replace_node on old"
+				                         " or new data if they don't exist in the graph");
+			}
+			if (old_data == new_data) {
+				return;
+			}
+			// Get a pointer to old data node
+			auto& oNode = locate(old_data)->second;
+			// Get a pointer to new data node
+			auto& nNode = locate(new_data)->second;
+			// Copy the old outgoing edges onto new. A self loop on old becomes a self loop on new.
+			for (auto j = oNode.edges->begin(); j != oNode.edges->end(); ++j) {
+				auto& dst = (j->first == oNode.id) ? nNode : ids_[index(j->first)]->second;
+				add_edge(nNode, dst, j->second);
+			}
+			// Set the old incoming edges to point to new
+			// The reverse index tells us exactly which sources have edges into old.
+			auto moved = std::vector<E>{};
+			for (auto i = oNode.incoming->begin(); i != oNode.incoming->end(); ++i) {
+				if (i->first == oNode.id) {
+					continue;
+				}
+				auto& src = ids_[index(i->first)]->second;
+				// Adding to the block moves its edges, so take the weights out first.
+				auto [first, last] = std::equal_range(src.edges->begin(), src.edges->end(), oNode.id, edge_order());
+				moved.clear();
+				for (auto j = first; j != last; ++j) {
+					moved.push_back(j->second);
+				}
+				for (auto const& weight : moved) {
+					// Create a new edge and add it to "i" as an outgoing node
+					add_edge(src, nNode, weight);
+				}
+			}
+			// Finally delete the old node totally.
+			record<nodes_merged>(old_data, new_data);
+			remove_node(locate(old_data));
+		}
+
+		auto erase_node(N const& value) -> bool {
+			[[maybe_unused]] auto const timer = timed(detail::operation::erase_node);
+			auto oNode = locate(value);
+			if (oNode == graph_.end()) {
+				return false;
+			}
+			record<node_erased>(value);
+			remove_node(oNode);
+			return true;
+		}
+
+		auto erase_edge(N const& src, N const& dst, E const& weight) -> bool {
+			[[maybe_unused]] auto const timer = timed(detail::operation::erase_edge);
+			auto sNode = locate(src);
+			auto dNode = locate(dst);
+			if (sNode == graph_.end() || dNode == graph_.end()) {
+				throw std::runtime_error("Cannot call gdwg::graph<N, E>::erase_edge on src or dst "
+				                         "if they don't exist in the graph");
+			}
+			auto at = find_edge(sNode->second, edgePair{dNode->second.id, weight});
+			if (at == sNode->second.edges->end()) {
+				return false;
+			}
+			auto offset = at - sNode->second.edges->begin();
+			auto& edges = sNode->second.edges.edit(alloc_);
+			edges.erase(edges.begin() + offset);
+			// Drop the reverse index entry once the last edge from src is gone.
+			auto& incoming = dNode->second.incoming.edit(alloc_);
+			auto count = incoming.find(sNode->second.id);
+			if (--(count->second) == 0) {
+				incoming.erase(count);
+			}
+			lookup_.remove_edge(raw_id(sNode->second.id), raw_id(dNode->second.id));
+			record<edge_erased>(src, dst, weight);
+			return true;
+		}
+
+		auto erase_edge(iterator i) -> iterator {
+			// The edges after it in the block move down one, so the next edge ends up where the
+			// erased one was.
+			auto edge = *i;
+			auto src = i.curr_;
+			auto offset = static_cast<std::size_t>(i.pos_ - src->second.edges->begin());
+			if (erase_edge(edge.from, edge.to, edge.weight)) {
+				return edge_at<iterator>(src, offset);
+			}
+			return end();
+		}
+
+		auto erase_edge(iterator i, iterator s) -> iterator {
+			// Erasing moves the edges after it, so count the edges to erase rather than erase
+			// up to s.
+			for (auto count = std::distance(i, s); count > 0; --count) {
+				i = erase_edge(i);
+			}
+			return i;
+		}
+
+		// With a monotonic arena the nodes are only destroyed here; their memory goes back when
+		// the arena itself is released.
+		auto clear() noexcept -> void {
+			graph_.clear();
+			ids_.clear();
+			free_ids_.clear();
+			lookup_.clear();
+			if (node_values_) {
+				node_values_->clear();
+			}
+			record<cleared>();
+		}
+
+		/***************************************
+		**                                    **
+		**          Change journal            **
+		**                                    **
+		***************************************/
+
+		using delta = gdwg::delta<N, E>;
+		using change = typename delta::change;
+		using node_inserted = typename delta::node_inserted;
+		using node_erased = typename delta::node_erased;
+		using node_replaced = typename delta::node_replaced;
+		using nodes_merged = typename delta::nodes_merged;
+		using edge_inserted = typename delta::edge_inserted;
+		using edge_erased = typename delta::edge_erased;
+		using cleared = typename delta::cleared;
+
+		// This function returns how many successful changes the graph has seen. A copy starts
+		// at the version of the graph it was copied from.
+		[[nodiscard]] auto version() const noexcept -> std::uint64_t {
+			return version_;
+		}
+
+		// This function starts keeping every change from the current version on, so replicas
+		// can be brought up to date with changes_since() instead of a full copy.
+		auto start_journal() -> void {
+			if (!journal_) {
+				journal_ = std::make_unique<journal>(version_, alloc_);
+			}
+		}
+
+		// This function stops journaling and drops every change kept so far.
+		auto stop_journal() noexcept -> void {
+			journal_.reset();
+		}
+
+		[[nodiscard]] auto is_journaling() const noexcept -> bool {
+			return journal_ != nullptr;
+		}
+
+		// This function returns every change made after version since. The journal has to
+		// have been running since then, and must not have been trimmed past it.
+		[[nodiscard]] auto changes_since(std::uint64_t since) const -> delta {
+			if (!journal_ || since < journal_->first_version || since > version_) {
+				throw std::runtime_error("Cannot call gdwg::graph<N, E>::changes_since on a version "
+				                         "the journal doesn't cover");
+			}
+			auto first = journal_->changes.begin()
+			             + static_cast<std::ptrdiff_t>(since - journal_->first_version);
+			return delta{since, version_, std::vector<change>(first, journal_->changes.end())};
+		}
+
+		// This function drops the changes made before version until, once every replica has
+		// them.
+		auto trim_journal(std::uint64_t until) -> void {
+			if (!journal_ || until <= journal_->first_version) {
+				return;
+			}
+			until = std::min(until, version_);
+			auto& changes = journal_->changes;
+			auto dropped = static_cast<std::ptrdiff_t>(until - journal_->first_version);
+			changes.erase(changes.begin(), changes.begin() + dropped);
+			journal_->first_version = until;
+		}
+
+		// This function replays a delta taken from another graph. This graph has to be at the
+		// version the delta starts from, which holds for a copy of that graph made at that
+		// version with only deltas applied since. Every change has to apply cleanly; the first
+		// one that doesn't throws, leaving the changes before it in place.
+		auto apply(delta const& d) -> void {
+			if (d.from_version != version_) {
+				throw std::runtime_error("Cannot call gdwg::graph<N, E>::apply with a delta that "
+				                         "doesn't start at this graph's version");
+			}
+			for (auto const& entry : d.changes) {
+				auto before = version_;
+				std::visit([this](auto const& c) { replay(c); }, entry);
+				if (version_ != before + 1) {
+					throw std::runtime_error("Cannot call gdwg::graph<N, E>::apply with a delta that "
+					                         "doesn't match this graph");
+				}
+			}
+		}
+
 		/***************************************
 		**                                    **
-		**       Transparent Comparators      **
+		**          Instrumentation           **
 		**                                    **
 		***************************************/
-		using edgePair = std::pair<std::weak_ptr<N>, E>;
 
-		struct mapComparator {
-			using is_transparent = void;
-			// this overload will sort the source nodes of the map in increasing order.
-			bool operator()(std::shared_ptr<N> const& a, std::shared_ptr<N> const& b) const {
-				return *a < *b;
+		// This function returns what this graph has counted since it was created or since
+		// reset_stats(). A copy of a graph starts from zero.
+		[[nodiscard]] auto stats() const noexcept -> graph_stats {
+#ifdef GDWG_GRAPH_STATS
+			return stats_->snapshot();
+#else
+			return graph_stats{};
+#endif
+		}
+
+		auto reset_stats() noexcept -> void {
+#ifdef GDWG_GRAPH_STATS
+			stats_->reset();
+#endif
+		}
+
+		/***************************************
+		**                                    **
+		**            Accessors               **
+		**                                    **
+		***************************************/
+
+		[[nodiscard]] auto get_allocator() const noexcept -> allocator_type {
+			return alloc_;
+		}
+
+		// This function tells us if the node exists in the graph.
+		[[nodiscard]] auto is_node(N const& value) const -> bool {
+			return (locate(value) != graph_.end());
+		}
+
+		// This function tells us if an ID belongs to a node in the graph.
+		[[nodiscard]] auto is_node(id_type id) const noexcept -> bool {
+			return index(id) < ids_.size() && (*node_values_)[index(id)] != nullptr;
+		}
+
+		// This function tells us if the graph is empty.
+		[[nodiscard]] auto empty() const noexcept -> bool {
+			return graph_.empty();
+		}
+
+		// Function that returns total number of nodes for testing purposes.
+		[[nodiscard]] auto size() const noexcept -> int {
+			return static_cast<int>(graph_.size());
+		}
+
+		// This function returns the interned ID of a node.
+		[[nodiscard]] auto node_id(N const& value) const -> id_type {
+			auto sNode = locate(value);
+			if (sNode == graph_.end()) {
+				throw std::runtime_error("Cannot call gdwg::graph<N, E>::node_id on a node that "
+				                         "doesn't exist");
 			}
-			// this overload is used when the map.find(something) is called.
-			// comparator made for both lhs and rhs cases.
-			auto operator()(std::shared_ptr<N> const& a, N const& b) const noexcept -> bool {
-				return *a < b;
+			return sNode->second.id;
+		}
+
+		// This function returns the node behind an interned ID.
+		[[nodiscard]] auto node(id_type id) const -> N const& {
+			if (!is_node(id)) {
+				throw std::runtime_error("Cannot call gdwg::graph<N, E>::node on an ID that "
+				                         "doesn't exist");
 			}
-			auto operator()(N const& a, std::shared_ptr<N> const& b) const noexcept -> bool {
-				return a < *b;
+			return *((*node_values_)[index(id)]);
+		}
+
+		// Every ID in use is below this bound, so it can size arrays indexed by ID.
+		[[nodiscard]] auto id_bound() const noexcept -> std::size_t {
+			return ids_.size();
+		}
+
+		// This function returns the edges leaving an interned node as (destination ID, weight)
+		// pairs, in the same order the iterator visits them.
+		[[nodiscard]] auto out_edges(id_type src) const -> destination_node const& {
+			if (!is_node(src)) {
+				throw std::runtime_error("Cannot call gdwg::graph<N, E>::out_edges if src doesn't"
+				                         " exist in the graph");
 			}
-		};
+			return *ids_[index(src)]->second.edges;
+		}
 
-		struct setComparator {
-			using is_transparent = void;
-			// This overload will sort the destination node(edges) in increasing order.
-			// If the destination node is the same then it is sorted by weight "E"
-			bool operator()(edgePair const& a, edgePair const& b) const {
-				return ((*((a.first).lock()) < *((b.first).lock()))
-				        || ((*((a.first).lock()) == *((b.first).lock())) && (a.second < b.second)));
+		// This function returns the sources with edges into an interned node, each with the number
+		// of edges it has into it, ordered by ID.
+		[[nodiscard]] auto in_edges(id_type dst) const -> incoming_map const& {
+			if (!is_node(dst)) {
+				throw std::runtime_error("Cannot call gdwg::graph<N, E>::in_edges if dst doesn't"
+				                         " exist in the graph");
+			}
+			return *ids_[index(dst)]->second.incoming;
+		}
+
+		// This function tells us if a connection exists between src and dst.
+		[[nodiscard]] auto is_connected(N const& src, N const& dst) const -> bool {
+			// Get the key value pair related to src.
+			auto sNode = locate(src);
+			auto dNode = locate(dst);
+			// error testing.
+			if (sNode == graph_.end() || dNode == graph_.end()) {
+				throw std::runtime_error("Cannot call gdwg::graph<N, E>::is_connected if src or dst"
+				                         " node don't exist in the graph");
+			}
+			if constexpr (std::is_same_v<Lookup, hashed_lookup>) {
+				return lookup_.is_connected(raw_id(sNode->second.id), raw_id(dNode->second.id));
+			}
+			else {
+				// sNode->second.edges is the set(value).
+				return std::binary_search(sNode->second.edges->begin(),
+				                          sNode->second.edges->end(),
+				                          dNode->second.id,
+				                          edge_order());
+			}
+		}
+
+		// This function tells us if a connection exists between two interned node IDs.
+		[[nodiscard]] auto is_connected(id_type src, id_type dst) const -> bool {
+			if (!is_node(src) || !is_node(dst)) {
+				throw std::runtime_error("Cannot call gdwg::graph<N, E>::is_connected if src or dst"
+				                         " node don't exist in the graph");
+			}
+			if constexpr (std::is_same_v<Lookup, hashed_lookup>) {
+				return lookup_.is_connected(raw_id(src), raw_id(dst));
+			}
+			else {
+				auto const& edges = *ids_[index(src)]->second.edges;
+				return std::binary_search(edges.begin(), edges.end(), dst, edge_order());
+			}
+		}
+
+		// This function returns a vector of all the nodes in the graph.
+		[[nodiscard]] auto nodes() const -> std::vector<N> {
+			auto view = nodes_view();
+			return std::vector<N>(view.begin(), view.end());
+		}
+
+		// This function returns every node in the graph without copying them.
+		[[nodiscard]] auto nodes_view() const -> node_view {
+			using It = typename node_view::iterator_type;
+			return node_view{It{graph_.begin(), graph_.end(), {}}, It{graph_.end(), graph_.end(), {}}};
+		}
+
+		// This function returns a vector of all the weight between 2 nodes.
+		[[nodiscard]] auto weights(N const& src, N const& dst) const -> std::vector<E> {
+			auto sNode = locate(src);
+			auto dNode = locate(dst);
+			if (sNode == graph_.end() || dNode == graph_.end()) {
+				throw std::runtime_error("Cannot call gdwg::graph<N, E>::weights if src or dst node"
+				                         " don't exist in the graph");
+			}
+			auto view = weights_between(sNode->second, dNode->second.id);
+			return std::vector<E>(view.begin(), view.end());
+		}
+
+		// This function returns the weights between 2 nodes without copying them.
+		// The edges to one destination sit next to each other, so this is one equal_range.
+		[[nodiscard]] auto weights_view(N const& src, N const& dst) const -> weight_view {
+			auto sNode = locate(src);
+			auto dNode = locate(dst);
+			if (sNode == graph_.end() || dNode == graph_.end()) {
+				throw std::runtime_error("Cannot call gdwg::graph<N, E>::weights_view if src or dst"
+				                         " node don't exist in the graph");
+			}
+			return weights_between(sNode->second, dNode->second.id);
+		}
+
+		// This function returns an iterator to an edge.
+		[[nodiscard]] auto find(N const& src, N const& dst, E const& weight) const -> iterator {
+			auto srcNode = locate(src);
+			auto dNode = locate(dst);
+			if (srcNode == graph_.end() || dNode == graph_.end()) {
+				return end();
+			}
+			if constexpr (std::is_same_v<Lookup, hashed_lookup>) {
+				// Most misses don't need to search the set at all.
+				if (!lookup_.is_connected(raw_id(srcNode->second.id), raw_id(dNode->second.id))) {
+					return end();
+				}
+			}
+			auto foundEdge = find_edge(srcNode->second, edgePair{dNode->second.id, weight});
+			if (foundEdge == srcNode->second.edges->end()) {
+				return end();
+			}
+			else {
+				return iterator{srcNode, graph_.end(), foundEdge, node_values_.get()};
+			}
+		}
+
+		// These functions search the edges leaving src by (dst, weight), the order they are kept
+		// in, so each one is a binary search of src's block. dst doesn't have to be a node.
+		// They return the first edge from src not before (dst, weight), or not before dst when
+		// weight is left out.
+		[[nodiscard]] auto lower_bound(N const& src, N const& dst) const -> iterator {
+			auto sNode = bounded_source(src,
+			                            "Cannot call gdwg::graph<N, E>::lower_bound if src doesn't"
+			                            " exist in the graph");
+			auto order = edge_order();
+			return bound(sNode, [&](edgePair const& e) { return order(e, dst); });
+		}
+
+		[[nodiscard]] auto lower_bound(N const& src, N const& dst, E const& weight) const -> iterator {
+			auto sNode = bounded_source(src,
+			                            "Cannot call gdwg::graph<N, E>::lower_bound if src doesn't"
+			                            " exist in the graph");
+			auto order = edge_order();
+			return bound(sNode, [&](edgePair const& e) {
+				return order(e, dst) || (!order(dst, e) && e.second < weight);
+			});
+		}
+
+		// These return the first edge from src after every edge to dst, or after (dst, weight).
+		[[nodiscard]] auto upper_bound(N const& src, N const& dst) const -> iterator {
+			auto sNode = bounded_source(src,
+			                            "Cannot call gdwg::graph<N, E>::upper_bound if src doesn't"
+			                            " exist in the graph");
+			auto order = edge_order();
+			return bound(sNode, [&](edgePair const& e) { return !order(dst, e); });
+		}
+
+		[[nodiscard]] auto upper_bound(N const& src, N const& dst, E const& weight) const -> iterator {
+			auto sNode = bounded_source(src,
+			                            "Cannot call gdwg::graph<N, E>::upper_bound if src doesn't"
+			                            " exist in the graph");
+			auto order = edge_order();
+			return bound(sNode, [&](edgePair const& e) {
+				return order(e, dst) || (!order(dst, e) && !(weight < e.second));
+			});
+		}
+
+		// This function returns the edges from src to dst, in weight order.
+		[[nodiscard]] auto edges_between(N const& src, N const& dst) const
+		   -> std::pair<iterator, iterator> {
+			return {lower_bound(src, dst), upper_bound(src, dst)};
+		}
+
+		// This function returns the edges from src to dst with a weight in [lo, hi). The range
+		// is empty when hi isn't after lo.
+		[[nodiscard]] auto edges_between(N const& src, N const& dst, E const& lo, E const& hi) const
+		   -> std::pair<iterator, iterator> {
+			auto first = lower_bound(src, dst, lo);
+			if (!(lo < hi)) {
+				return {first, first};
+			}
+			return {first, lower_bound(src, dst, hi)};
+		}
+
+		// This function returns every edge leaving src.
+		[[nodiscard]] auto edges_from(N const& src) const -> std::pair<iterator, iterator> {
+			auto sNode = bounded_source(src,
+			                            "Cannot call gdwg::graph<N, E>::edges_from if src doesn't"
+			                            " exist in the graph");
+			return {edge_at<iterator>(sNode, 0), edge_at<iterator>(sNode, sNode->second.edges->size())};
+		}
+
+		// This function returns a vector of all the nodes leaving src.
+		[[nodiscard]] auto connections(N const& src) const -> std::vector<N> {
+			auto sNode = locate(src);
+			if (sNode == graph_.end()) {
+				throw std::runtime_error("Cannot call gdwg::graph<N, E>::connections if src doesn't"
+				                         " exist in the graph");
+			}
+			auto view = neighbors_of(sNode->second);
+			return std::vector<N>(view.begin(), view.end());
+		}
+
+		// This function returns the nodes leaving src without copying them. The set is sorted by
+		// destination, so repeats are skipped by comparing neighbouring edges.
+		[[nodiscard]] auto neighbors(N const& src) const -> neighbor_view {
+			auto sNode = locate(src);
+			if (sNode == graph_.end()) {
+				throw std::runtime_error("Cannot call gdwg::graph<N, E>::neighbors if src doesn't"
+				                         " exist in the graph");
+			}
+			return neighbors_of(sNode->second);
+		}
+
+		// This function returns the (dst, weight) pairs of the edges leaving src without copying
+		// them.
+		[[nodiscard]] auto out_edges(N const& src) const -> out_edge_view {
+			auto sNode = locate(src);
+			if (sNode == graph_.end()) {
+				throw std::runtime_error("Cannot call gdwg::graph<N, E>::out_edges if src doesn't"
+				                         " exist in the graph");
+			}
+			using It = typename out_edge_view::iterator_type;
+			auto const& edges = *sNode->second.edges;
+			auto project = project_edge{node_values_.get()};
+			return out_edge_view{It{edges.begin(), edges.end(), project},
+			                     It{edges.end(), edges.end(), project}};
+		}
+
+		// This function returns a vector of all the nodes with an edge going into dst.
+		[[nodiscard]] auto in_connections(N const& dst) const -> std::vector<N> {
+			auto dNode = locate(dst);
+			if (dNode == graph_.end()) {
+				throw std::runtime_error("Cannot call gdwg::graph<N, E>::in_connections if dst "
+				                         "doesn't exist in the graph");
+			}
+			std::vector<N> v;
+			for (auto it = dNode->second.incoming->begin(); it != dNode->second.incoming->end(); ++it) {
+				v.emplace_back(node(it->first));
+			}
+			// The index is keyed by ID, so sort to match the order connections() uses.
+			std::sort(v.begin(), v.end());
+			return v;
+		}
+
+		/***************************************
+		**                                    **
+		**           Batch queries            **
+		**                                    **
+		***************************************/
+		// Each of these answers a whole span of queries, in the order of the queries. They are
+		// grouped by source first, so every source is looked up once and its edges are searched
+		// from front to back. Large batches are split between threads by source; zero threads
+		// uses every core. They throw like the single queries do.
+
+		[[nodiscard]] auto is_connected_batch(std::span<std::pair<N, N> const> queries,
+		                                      unsigned threads = 1) const -> std::vector<bool> {
+			auto connected = std::vector<char>(queries.size(), 0);
+			by_source(
+			   queries.size(),
+			   [queries](std::size_t i) -> N const& { return queries[i].first; },
+			   [queries](std::size_t a, std::size_t b) { return queries[a] < queries[b]; },
+			   threads,
+			   [&](auto src, std::size_t const* first, std::size_t const* last) {
+				   if (src == graph_.end()) {
+					   throw std::runtime_error("Cannot call gdwg::graph<N, E>::is_connected_batch if "
+					                            "src or dst node don't exist in the graph");
+				   }
+				   auto const& edges = *src->second.edges;
+				   auto at = edges.begin();
+				   for (; first != last; ++first) {
+					   auto const& dst = queries[*first].second;
+					   at = std::lower_bound(at, edges.end(), dst, edge_order());
+					   if (at != edges.end() && !edge_order()(dst, *at)) {
+						   connected[*first] = 1;
+					   }
+					   // Only a miss has to check that dst is there at all.
+					   else if (locate(dst) == graph_.end()) {
+						   throw std::runtime_error("Cannot call gdwg::graph<N, E>::is_connected_batch "
+						                            "if src or dst node don't exist in the graph");
+					   }
+				   }
+			   });
+			return std::vector<bool>(connected.begin(), connected.end());
+		}
+
+		[[nodiscard]] auto find_batch(std::span<value_type const> queries, unsigned threads = 1) const
+		   -> std::vector<iterator> {
+			auto found = std::vector<iterator>(queries.size(), end());
+			auto order = edge_order();
+			// Edges are ordered by destination node and then by weight.
+			auto before = [order](edgePair const& edge, value_type const& q) {
+				return order(edge, q.to) || (!order(q.to, edge) && edge.second < q.weight);
+			};
+			by_source(
+			   queries.size(),
+			   [queries](std::size_t i) -> N const& { return queries[i].from; },
+			   [queries](std::size_t a, std::size_t b) {
+				   auto const& x = queries[a];
+				   auto const& y = queries[b];
+				   if (x.from < y.from || y.from < x.from) {
+					   return x.from < y.from;
+				   }
+				   if (x.to < y.to || y.to < x.to) {
+					   return x.to < y.to;
+				   }
+				   return x.weight < y.weight;
+			   },
+			   threads,
+			   [&](auto src, std::size_t const* first, std::size_t const* last) {
+				   if (src == graph_.end()) {
+					   return;
+				   }
+				   auto const& edges = *src->second.edges;
+				   auto at = edges.begin();
+				   for (; first != last; ++first) {
+					   auto const& q = queries[*first];
+					   at = std::lower_bound(at, edges.end(), q, before);
+					   if (at != edges.end() && !order(q.to, *at) && !(q.weight < at->second)) {
+						   found[*first] = iterator{src, graph_.end(), at, node_values_.get()};
+					   }
+				   }
+			   });
+			return found;
+		}
+
+		[[nodiscard]] auto connections_batch(std::span<N const> sources, unsigned threads = 1) const
+		   -> std::vector<std::vector<N>> {
+			auto connected = std::vector<std::vector<N>>(sources.size());
+			by_source(
+			   sources.size(),
+			   [sources](std::size_t i) -> N const& { return sources[i]; },
+			   [sources](std::size_t a, std::size_t b) { return sources[a] < sources[b]; },
+			   threads,
+			   [&](auto src, std::size_t const* first, std::size_t const* last) {
+				   if (src == graph_.end()) {
+					   throw std::runtime_error("Cannot call gdwg::graph<N, E>::connections_batch if "
+					                            "src doesn't exist in the graph");
+				   }
+				   auto view = neighbors_of(src->second);
+				   connected[*first].assign(view.begin(), view.end());
+				   // Repeats of the same source get a copy.
+				   for (auto i = first + 1; i != last; ++i) {
+					   connected[*i] = connected[*first];
+				   }
+			   });
+			return connected;
+		}
+
+		// This function builds an immutable compressed sparse row snapshot of the graph.
+		// The snapshot iterates in the same order as graph::iterator.
+		[[nodiscard]] auto freeze() const -> frozen_graph<N, E> {
+			return frozen_graph<N, E>(*this);
+		}
+
+		/*
+		[[nodiscard]] auto operator==(graph const& other) -> bool {
+		   auto a = other.graph_.begin();
+		   while (a !=)
+		}
+		*/
+		friend auto operator<<(std::ostream& os, graph const& g) -> std::ostream& {
+			for (auto iter = g.graph_.begin(); iter != g.graph_.end(); ++iter) {
+				os << *(iter->first) << "(" << '\n';
+				for (auto it = iter->second.edges->begin(); it != iter->second.edges->end(); ++it) {
+					os << '\t' << g.node(it->first) << " | " << (it->second) << '\n';
+				}
+				os << ")" << '\n';
+			}
+			return os;
+		}
+
+	private:
+		friend class frozen_graph<N, E>;
+
+		using lookup_index = typename detail::lookup_index_for<Lookup, N, Allocator>::type;
+
+		static auto index(id_type id) noexcept -> std::size_t {
+			return static_cast<std::size_t>(id);
+		}
+
+		static auto raw_id(id_type id) noexcept -> std::uint32_t {
+			return static_cast<std::uint32_t>(id);
+		}
+
+		// Returns the map entry of value, or graph_.end(). With hashed_lookup this is one probe
+		// of the hash index instead of a walk down the map.
+		auto locate(N const& value) -> typename node_map::iterator {
+			if constexpr (std::is_same_v<Lookup, hashed_lookup>) {
+				auto id = node_values_ ? lookup_.find_node(value, *node_values_) : lookup_index::npos;
+				return id == lookup_index::npos ? graph_.end() : ids_[id];
+			}
+			else {
+				return graph_.find(value);
+			}
+		}
+
+		auto locate(N const& value) const -> typename node_map::const_iterator {
+			if constexpr (std::is_same_v<Lookup, hashed_lookup>) {
+				auto id = node_values_ ? lookup_.find_node(value, *node_values_) : lookup_index::npos;
+				return id == lookup_index::npos ? graph_.end()
+				                                : typename node_map::const_iterator{ids_[id]};
+			}
+			else {
+				return graph_.find(value);
+			}
+		}
+
+		// The order the edges leaving each node are kept in.
+		auto edge_order() const noexcept -> setComparator {
+#ifdef GDWG_GRAPH_STATS
+			return setComparator{node_values_.get(), stats_.get()};
+#else
+			return setComparator{node_values_.get()};
+#endif
+		}
+
+		// The node map's comparator, with new counters when they are compiled in.
+		static auto node_order() -> mapComparator {
+#ifdef GDWG_GRAPH_STATS
+			return mapComparator{std::make_shared<detail::graph_counters>()};
+#else
+			return mapComparator{};
+#endif
+		}
+
+		// Times the rest of the calling modifier as op.
+		[[nodiscard]] auto timed([[maybe_unused]] detail::operation op) const noexcept
+		   -> detail::operation_timer {
+#ifdef GDWG_GRAPH_STATS
+			return detail::operation_timer(stats_->of(op));
+#else
+			return detail::operation_timer{};
+#endif
+		}
+
+		// Sorts count queries with before, which has to order them by source(i) first, and
+		// calls answer(entry, first, last) for each run [first, last) of query indexes with the
+		// same source. entry is the source's map entry, or graph_.end(). The runs are spread over
+		// threads, and the first exception any of them throws is thrown here.
+		template<typename Source, typename Before, typename Answer>
+		auto by_source(std::size_t count, Source source, Before before, unsigned threads, Answer answer) const
+		   -> void {
+			auto order = std::vector<std::size_t>(count);
+			std::iota(order.begin(), order.end(), std::size_t{0});
+			std::sort(order.begin(), order.end(), before);
+			auto runs = std::vector<std::size_t>{};
+			for (auto i = std::size_t{0}; i < count; ++i) {
+				if (i == 0 || source(order[i - 1]) < source(order[i])) {
+					runs.push_back(i);
+				}
+			}
+			runs.push_back(count);
+			auto const run_count = runs.size() - 1;
+			auto workers = detail::worker_count(detail::thread_count(threads), run_count);
+			auto errors = std::vector<std::exception_ptr>(workers);
+			detail::parallel_for(workers, run_count, [&](std::size_t worker, std::size_t first, std::size_t last) {
+				try {
+					for (auto r = first; r < last; ++r) {
+						answer(locate(source(order[runs[r]])),
+						       order.data() + runs[r],
+						       order.data() + runs[r + 1]);
+					}
+				} catch (...) {
+					errors[worker] = std::current_exception();
+				}
+			});
+			for (auto const& error : errors) {
+				if (error) {
+					std::rethrow_exception(error);
+				}
+			}
+		}
+
+		// Returns the edge of src equivalent to edge, or the end of its edges.
+		auto find_edge(node_entry const& src, edgePair const& edge) const ->
+		   typename destination_node::const_iterator {
+			auto const& edges = *src.edges;
+			auto i = std::lower_bound(edges.begin(), edges.end(), edge, edge_order());
+			return (i != edges.end() && !edge_order()(edge, *i)) ? i : edges.end();
+		}
+
+		// Returns src's map entry for the bound queries, which need it to be a node.
+		auto bounded_source(N const& src, char const* message) const ->
+		   typename node_map::const_iterator {
+			auto sNode = locate(src);
+			if (sNode == graph_.end()) {
+				throw std::runtime_error(message);
+			}
+			return sNode;
+		}
+
+		// Returns an iterator to the first edge of src for which before is false. before has to
+		// be true for a prefix of src's block and false for the rest.
+		template<typename Before>
+		auto bound(typename node_map::const_iterator src, Before before) const -> iterator {
+			auto const& edges = *src->second.edges;
+			auto at = std::partition_point(edges.begin(), edges.end(), before);
+			return edge_at<iterator>(src, static_cast<std::size_t>(at - edges.begin()));
+		}
+
+		auto weights_between(node_entry const& src, id_type dst) const -> weight_view {
+			using It = typename weight_view::iterator_type;
+			auto [first, last] = std::equal_range(src.edges->begin(), src.edges->end(), dst, edge_order());
+			return weight_view{It{first, last, {}}, It{last, last, {}}};
+		}
+
+		auto neighbors_of(node_entry const& src) const -> neighbor_view {
+			using It = typename neighbor_view::iterator_type;
+			auto project = project_destination{node_values_.get()};
+			return neighbor_view{It{src.edges->begin(), src.edges->end(), project},
+			                     It{src.edges->end(), src.edges->end(), project}};
+		}
+
+		// Returns an iterator of type It to the first edge.
+		template<typename It>
+		auto first_edge() const -> It {
+			return edge_at<It>(graph_.begin(), 0);
+		}
+
+		// Returns an iterator of type It to the edge at offset in the block of src, or to the
+		// first edge after src's block if offset is past its end.
+		template<typename It>
+		auto edge_at(typename node_map::const_iterator src, std::size_t offset) const -> It {
+			// Skip over any nodes that have no outgoing edges left.
+			for (auto i = src; i != graph_.end(); ++i, offset = 0) {
+				if (offset < i->second.edges->size()) {
+					auto pos = i->second.edges->begin() + static_cast<std::ptrdiff_t>(offset);
+					return It{i, graph_.end(), pos, node_values_.get()};
+				}
+			}
+			return It{graph_.end(), graph_.end(), {}, node_values_.get()};
+		}
+
+		// Sorts a batch of edges into iteration order and removes the repeats.
+		static auto sort_batch(std::vector<value_type>& batch) -> void {
+			std::sort(batch.begin(), batch.end(), [](value_type const& a, value_type const& b) {
+				if (a.from != b.from) {
+					return a.from < b.from;
+				}
+				if (a.to != b.to) {
+					return a.to < b.to;
+				}
+				return a.weight < b.weight;
+			});
+			auto last_unique =
+			   std::unique(batch.begin(), batch.end(), [](value_type const& a, value_type const& b) {
+				   return a.from == b.from && a.to == b.to && a.weight == b.weight;
+			   });
+			batch.erase(last_unique, batch.end());
+		}
+
+		// Inserts a batch from sort_batch(). Duplicates are only the edges already in the graph.
+		auto insert_sorted_edges(std::vector<value_type> const& batch) -> bulk_insert_result {
+			// A run is a group of edges with the same source and destination.
+			struct run {
+				node_entry* src;
+				node_entry* dst;
+				std::size_t first;
+				std::size_t last;
+			};
+			// First find every node, so we can throw before anything has been changed.
+			auto runs = std::vector<run>{};
+			auto sNode = graph_.end();
+			for (auto i = std::size_t{0}; i < batch.size(); ++i) {
+				if (i == 0 || batch[i].from != batch[i - 1].from) {
+					sNode = locate(batch[i].from);
+				}
+				else if (batch[i].to == batch[i - 1].to) {
+					++runs.back().last;
+					continue;
+				}
+				auto dNode = locate(batch[i].to);
+				if (sNode == graph_.end() || dNode == graph_.end()) {
+					throw std::runtime_error("Cannot call gdwg::graph<N, E>::insert_edges when either "
+					                         "src or dst node does not exist");
+				}
+				runs.push_back(run{&sNode->second, &dNode->second, i, i + 1});
+			}
+			// Then merge each run into its block. The run and the edges already in the block to
+			// that destination are both sorted by weight, so one pass finds the new ones.
+			auto result = bulk_insert_result{};
+			auto added = std::vector<edgePair>{};
+			for (auto r = runs.begin(); r != runs.end(); ++r) {
+				auto const& existing = *r->src->edges;
+				auto [lo, hi] = std::equal_range(existing.begin(), existing.end(), r->dst->id, edge_order());
+				auto start = lo - existing.begin();
+				auto stop = hi - existing.begin();
+				added.clear();
+				for (auto i = r->first; i < r->last; ++i) {
+					auto edge = edgePair{r->dst->id, batch[i].weight};
+					lo = std::lower_bound(lo, hi, edge, edge_order());
+					if (lo == hi || edge_order()(edge, *lo)) {
+						added.push_back(edge);
+					}
+				}
+				result.duplicates += (r->last - r->first) - added.size();
+				if (added.empty()) {
+					continue;
+				}
+				auto& edges = r->src->edges.edit(alloc_);
+				edges.insert(edges.begin() + stop, added.begin(), added.end());
+				std::inplace_merge(edges.begin() + start,
+				                   edges.begin() + stop,
+				                   edges.begin() + stop + static_cast<std::ptrdiff_t>(added.size()),
+				                   edge_order());
+				r->dst->incoming.edit(alloc_)[r->src->id] += added.size();
+				lookup_.add_edges(raw_id(r->src->id), raw_id(r->dst->id), added.size());
+				for (auto const& edge : added) {
+					record<edge_inserted>(batch[r->first].from, batch[r->first].to, edge.second);
+				}
+				result.inserted += added.size();
+			}
+			return result;
+		}
+
+		// Adds the edge src -> dst if it is new and records it in the reverse index.
+		auto add_edge(node_entry& src, node_entry& dst, E const& weight) -> bool {
+			// The block only takes the edge if it is not there already.
+			auto edge = edgePair{dst.id, weight};
+			auto const& edges = *src.edges;
+			auto at = std::lower_bound(edges.begin(), edges.end(), edge, edge_order());
+			if (at != edges.end() && !edge_order()(edge, *at)) {
+				return false;
+			}
+			auto offset = at - edges.begin();
+			auto& block = src.edges.edit(alloc_);
+			block.insert(block.begin() + offset, edge);
+			++dst.incoming.edit(alloc_)[src.id];
+			lookup_.add_edges(raw_id(src.id), raw_id(dst.id), 1);
+			return true;
+		}
+
+		// Takes a node and every edge into or out of it out of the graph, and gives its ID back.
+		auto remove_node(typename node_map::iterator oNode) -> void {
+			auto id = oNode->second.id;
+			// Deleteing all of the outgoing edges
+			// The edges to one destination sit together, so each destination is visited once.
+			auto const& out = *oNode->second.edges;
+			for (auto j = out.begin(); j != out.end(); ++j) {
+				if (j != out.begin() && j->first == std::prev(j)->first) {
+					continue;
+				}
+				ids_[index(j->first)]->second.incoming.edit(alloc_).erase(id);
+				lookup_.remove_edges(raw_id(id), raw_id(j->first));
 			}
-			// This overload is used when set.find() is used.
-			// Comparator made for both lhs and rhs cases.
-			auto operator()(edgePair const& a, N const& b) const noexcept -> bool {
-				return *((a.first).lock()) < b;
+			oNode->second.edges.reset();
+			// Deleteing all of the incoming edges
+			// Only the sources in the reverse index need to be visited, and their edges to this
+			// node are sorted next to each other.
+			for (auto i = oNode->second.incoming->begin(); i != oNode->second.incoming->end(); ++i) {
+				auto& src = ids_[index(i->first)]->second.edges;
+				auto [first, last] = std::equal_range(src->begin(), src->end(), id, edge_order());
+				if (first != last) {
+					auto from = first - src->begin();
+					auto to = last - src->begin();
+					auto& edges = src.edit(alloc_);
+					edges.erase(edges.begin() + from, edges.begin() + to);
+				}
+				lookup_.remove_edges(raw_id(i->first), raw_id(id));
 			}
-			auto operator()(N const& a, edgePair const& b) const noexcept -> bool {
-				return a < *((b.first).lock());
+			// Delete the node itself and give its ID back.
+			lookup_.erase_node(*oNode->first, *node_values_);
+			graph_.erase(oNode);
+			(*node_values_)[index(id)] = nullptr;
+			free_ids_.push_back(id);
+		}
+
+		// Counts a successful change and, while journaling, keeps it. A journal that can't
+		// grow is dropped, so changes_since() throws instead of handing out a delta with a
+		// gap in it.
+		template<typename Change, typename... Args>
+		auto record(Args const&... args) noexcept -> void {
+			++version_;
+			if (journal_) {
+				try {
+					journal_->changes.emplace_back(Change{args...});
+				} catch (...) {
+					journal_.reset();
+				}
 			}
-		};
+		}
 
-		// type defining the destination node to avoid redundency.
-		using destination_node = std::set<std::pair<std::weak_ptr<N>, E>, setComparator>;
+		auto replay(node_inserted const& c) -> void {
+			insert_node(c.value);
+		}
 
-		/***************************************
-		**                                    **
-		**          Custom Iterator           **
-		**                                    **
-		***************************************/
-		struct value_type {
-			N from;
-			N to;
-			E weight;
+		auto replay(node_erased const& c) -> void {
+			erase_node(c.value);
+		}
+
+		auto replay(node_replaced const& c) -> void {
+			replace_node(c.old_value, c.new_value);
+		}
+
+		auto replay(nodes_merged const& c) -> void {
+			merge_replace_node(c.old_value, c.new_value);
+		}
+
+		auto replay(edge_inserted const& c) -> void {
+			insert_edge(c.src, c.dst, c.weight);
+		}
+
+		auto replay(edge_erased const& c) -> void {
+			erase_edge(c.src, c.dst, c.weight);
+		}
+
+		auto replay(cleared const&) -> void {
+			clear();
+		}
+
+		// Puts a node into the map under an ID that has already been reserved.
+		auto add_node(std::shared_ptr<N> value, id_type id) -> void {
+			(*node_values_)[index(id)] = value.get();
+			ids_[index(id)] = graph_.emplace(std::move(value), node_entry{id, {}, {}}).first;
+		}
+
+		node_map graph_;
+		// ID -> node value. It lives on the heap so iterators and views can keep pointing at it
+		// when the graph is moved.
+		std::unique_ptr<node_table> node_values_;
+		// ID -> map entry
+		std::vector<typename node_map::iterator, rebind_alloc<typename node_map::iterator>> ids_;
+		std::vector<id_type, rebind_alloc<id_type>> free_ids_; // IDs of erased nodes, ready to be reused
+		[[no_unique_address]] lookup_index lookup_; // Hash indexes for hashed_lookup, empty otherwise
+		[[no_unique_address]] Allocator alloc_;
+
+		// The changes kept since first_version, oldest first.
+		struct journal {
+			journal(std::uint64_t first, Allocator const& alloc)
+			: first_version{first}
+			, changes(alloc) {}
+
+			std::uint64_t first_version;
+			std::vector<change, rebind_alloc<change>> changes;
 		};
 
-		class iterator {
-			using outer_iterator =
-			   typename std::map<std::shared_ptr<N>, destination_node, mapComparator>::const_iterator;
-			using inner_iterator = typename destination_node::const_iterator;
+		std::unique_ptr<journal> journal_; // Only there while journaling
+		std::uint64_t version_ = 0;
+#ifdef GDWG_GRAPH_STATS
+		// Shared with graph_'s comparator. The graph holds its own share, because a moved map may
+		// have moved its comparator out too.
+		std::shared_ptr<detail::graph_counters> stats_ = graph_.key_comp().stats;
+#endif
+	};
+
+	namespace pmr {
+		// A graph whose storage all comes from one std::pmr::memory_resource.
+		template<typename N, typename E>
+		using graph = gdwg::graph<N, E, std::pmr::polymorphic_allocator<N>>;
+	} // namespace pmr
+
+	/***************************************
+	**                                    **
+	**     Frozen (CSR) graph snapshot    **
+	**                                    **
+	***************************************/
+	// An immutable snapshot of a graph stored in compressed sparse row form.
+	// Nodes are given dense IDs in sorted order, so the edges leaving node i live in
+	// [offsets_[i], offsets_[i + 1]) of the contiguous destination and weight arrays.
+	template<typename N, typename E>
+	class frozen_graph {
+	public:
+		using id_type = std::uint32_t;
+		using value_type = typename graph<N, E>::value_type;
 
+		class iterator {
 		public:
-			using value_type = graph<N, E>::value_type;
+			using value_type = frozen_graph<N, E>::value_type;
 			using reference = value_type;
 			using pointer = void;
 			using difference_type = std::ptrdiff_t;
 			using iterator_category = std::bidirectional_iterator_tag;
 
-			iterator(const outer_iterator& curr, const outer_iterator& end, const inner_iterator& pos)
-			: curr_{curr}
-			, end_{end}
-			, pos_{pos} {};
+			iterator() = default;
 
-			auto operator*() noexcept -> reference {
-				value_type v;
-				v.from = *(curr_->first);
-				v.to = *(pos_->first.lock());
-				v.weight = (pos_->second);
-				return v;
+			iterator(frozen_graph const* g, std::size_t src, std::size_t pos)
+			: g_{g}
+			, src_{src}
+			, pos_{pos} {
+				skip_finished_sources();
+			};
+
+			auto operator*() const -> reference {
+				return value_type{g_->nodes_[src_], g_->nodes_[g_->dsts_[pos_]], g_->weights_[pos_]};
 			}
 
 			// pre increment
 			auto operator++() noexcept -> iterator& {
-				if (curr_ != end_) {
-					pos_++;
-					if (pos_ == ((curr_->second).end())) {
-						curr_++;
-						while (curr_ != end_) {
-							if (!(curr_->second).empty()) {
-								pos_ = (curr_->second).begin();
-								return *this;
-							}
-							curr_++;
-						}
-					}
-				}
+				++pos_;
+				skip_finished_sources();
 				return *this;
 			}
 
-			// post increment... strapped to pre increment.
 			auto operator++(int) noexcept -> iterator {
 				auto temp = *this;
 				++(*this);
@@ -122,359 +2930,155 @@ namespace gdwg {
 
 			// pre decrement
 			auto operator--() noexcept -> iterator& {
-				if (curr_ == end_) {
-					--curr_;
-					while ((curr_->second).empty()) {
-						--curr_;
-					}
-					pos_ = (curr_->second).cend();
-					pos_--;
-					return *this;
-				}
-				while (pos_ == (curr_->second).cbegin()) {
-					curr_--;
-					pos_ = (curr_->second).cend();
-				}
 				--pos_;
+				while (pos_ < g_->offsets_[src_]) {
+					--src_;
+				}
 				return *this;
 			}
 
-			// post decrement
 			auto operator--(int) noexcept -> iterator {
 				auto temp = *this;
 				--(*this);
 				return temp;
 			}
 
-			// Iterator comparison
-			auto operator==(iterator const& other) -> bool {
-				if (other.curr_ == other.end_ || curr_ == end_) {
-					return (other.curr_ == curr_);
-				}
-				else {
-					return ((other.pos_ == pos_) && (other.curr_ == curr_));
-				}
+			auto operator==(iterator const& other) const noexcept -> bool {
+				return pos_ == other.pos_;
 			}
 
 		private:
-			friend class graph;
-			outer_iterator curr_; // Current graph iterator
-			outer_iterator end_; // End iterator
-			inner_iterator pos_; // Position of inner iterator
-		};
-
-		[[nodiscard]] auto begin() const -> iterator {
-			return iterator{graph_.begin(), graph_.end(), ((graph_.begin())->second).begin()};
-		}
-
-		[[nodiscard]] auto end() const -> iterator {
-			return iterator{graph_.end(), graph_.end(), {}};
-		}
-
-		/***************************************
-		**                                    **
-		**           constructors             **
-		**                                    **
-		***************************************/
-
-		// Default constructor to create an empty map.
-		graph() noexcept = default;
-
-		// Create a graph using nodes from an initialiser list.
-		graph(std::initializer_list<N> il) noexcept {
-			for (auto i = il.begin(); i != il.end(); ++i) {
-				insert_node(*i);
-			}
-		}
-
-		// Creating a graph given all the start and end iter of an abject.
-		template<typename InputIt>
-		graph(InputIt first, InputIt last) {
-			for (auto i = first; i != last; ++i) {
-				insert_node(*i);
-			}
-		}
-
-		// Move constructor to create the graph.
-		graph(graph&& other) noexcept = default;
-
-		// Move operator to move-assign all the nodes of an old graph.
-		auto operator=(graph&& other) noexcept -> graph& = default;
-
-		// Copy constructor to copy the whole old graph.
-		graph(graph const& other) {
-			// We create memory copies of the src nodes because they can be modified.
-			// Note: We copy do modify memory for example in replace_node().
-			for (auto i = other.graph_.begin(); i != other.graph_.end(); ++i) {
-				insert_node(*(i->first));
-			}
-			// Next we copy all the destination(edges) nodes.
-			// Outer loop to iterate over the map.
-			for (auto i = other.graph_.begin(); i != other.graph_.end(); ++i) {
-				// Inner loop to iterate over the set.
-				if (i->second.size() == 0) {
-					continue;
-				}
-				for (auto j = i->second.begin(); j != i->second.end(); ++j) {
-					// auto node = graph_.find(*(j.first));
-					auto p1 = std::get<0>(*j).lock();
-					auto node = graph_.find(p1);
-					// Create a weak copy of the shared ptr.
-					std::weak_ptr<N> weak1 = node->first;
-					// Create a pair of weak ptr,E to insert into the set.
-					std::pair<std::weak_ptr<N>, E> edge1(weak1, std::get<1>(*j));
-					graph_[node->first].insert(edge1);
+			// Move the source forward past every node whose edges we have used up.
+			auto skip_finished_sources() noexcept -> void {
+				while (src_ < g_->nodes_.size() && pos_ >= g_->offsets_[src_ + 1]) {
+					++src_;
 				}
 			}
-		}
-
-		/***************************************
-		**                                    **
-		**            modifiers               **
-		**                                    **
-		***************************************/
-
-		// This function iserts a source node.
-		auto insert_node(N const& value) -> bool {
-			auto exist = graph_.find(value);
-			if (exist == graph_.end()) {
-				graph_[std::make_shared<N>(value)] = destination_node();
-				return true;
-			}
-			return false;
-		}
 
-		// This function inserts a new edge that is not in the graph.
-		auto insert_edge(N const& src, N const& dst, E const& weight) -> bool {
-			if (!is_node(src) || !is_node(dst)) {
-				throw std::runtime_error("Cannot call gdwg::graph<N, E>::insert_edge when either "
-				                         "src or dst node does not exist");
-			}
-			// sNode is the set of edges going from src.
-			auto sNode = graph_.find(src);
-			// We need to make an edge to check if it already exists.
-			// First we need to find the dst node share ptr and make a weak ptr.
-			auto dNode = graph_.find(dst);
-			std::weak_ptr<N> weak1 = dNode->first;
-			// Make a pair of the weak ptr from above and weight from the args.
-			std::pair<std::weak_ptr<N>, E> edge1(weak1, weight);
-			// Check if the edge exists.
-			auto foundEdge = sNode->second.find(edge1);
-			// If the edge does not exist, add new edge.
-			if (foundEdge == sNode->second.end()) {
-				graph_[sNode->first].insert(edge1);
-				return true;
-			}
-			return false;
-		}
+			frozen_graph const* g_ = nullptr;
+			std::size_t src_ = 0; // ID of the source node of the current edge
+			std::size_t pos_ = 0; // Index of the current edge
+		};
 
-		auto replace_node(N const& old_data, N const& new_data) -> bool {
-			if (!is_node(old_data)) {
-				throw std::runtime_error("Cannot call gdwg::graph<N, E>::replace_node on a node "
-				                         "that doesn't exist");
-			}
-			if (is_node(new_data)) {
-				return false;
-			}
-			// Get the key corresponding to old data
-			auto sNode = graph_.find(old_data)->first.get();
-			// std::cout<< "***" << *sNode->first <<"\n";
-			// std::cout<< sNode <<"\n";
-			*sNode = new_data;
-			std::cout << *sNode << "\n";
-			return true;
-		}
+		frozen_graph() = default;
 
-		auto merge_replace_node(N const& old_data, N const& new_data) -> void {
-			if (!is_node(old_data) || !is_node(new_data)) {
-				throw std::runtime_error("Cannot call gdwg::graph<N, E>::merge_replace_node on old"
-				                         " or new data if they don't exist in the graph");
+		// Snapshot every node and edge of g.
+		template<typename Allocator, typename Lookup>
+		explicit frozen_graph(graph<N, E, Allocator, Lookup> const& g) {
+			// The map is already sorted, so handing out IDs in map order keeps them sorted too.
+			// dense[i] is the snapshot ID of the node with graph ID i.
+			auto dense = std::vector<id_type>(g.ids_.size());
+			nodes_.reserve(g.graph_.size());
+			for (auto i = g.graph_.begin(); i != g.graph_.end(); ++i) {
+				dense[graph<N, E, Allocator, Lookup>::index(i->second.id)] = static_cast<id_type>(nodes_.size());
+				nodes_.emplace_back(*(i->first));
 			}
-			// Get a pointer to old data node
-			auto oNode = graph_.find(old_data);
-			// Get a pointer to new data node
-			auto nNode = graph_.find(new_data);
-			// Merge old set into new set
-			(nNode->second).merge(oNode->second);
-			// Set the old incoming edges to point to new
-			for (auto i = graph_.begin(); i != graph_.end(); ++i) {
-				if (i->second.size() == 0 || i->first == nNode->first || i->first == oNode->first) {
-					continue;
-				}
-				for (auto j = i->second.begin(); j != i->second.end(); ++j) {
-					if (*(j->first).lock() == old_data) {
-						// Create a new edge and add it to "i" as an outgoing node
-						std::weak_ptr<N> weak1 = nNode->first;
-						std::pair<std::weak_ptr<N>, E> edge1(weak1, j->second);
-						graph_[i->first].insert(edge1);
-					}
+			offsets_.reserve(nodes_.size() + 1);
+			for (auto i = g.graph_.begin(); i != g.graph_.end(); ++i) {
+				for (auto j = i->second.edges->begin(); j != i->second.edges->end(); ++j) {
+					dsts_.push_back(dense[graph<N, E, Allocator, Lookup>::index(j->first)]);
+					weights_.push_back(j->second);
 				}
+				offsets_.push_back(dsts_.size());
 			}
-			// Finally delete the old node totally.
-			erase_node(old_data);
 		}
 
-		auto erase_node(N const& value) -> bool {
-			auto oNode = graph_.find(value);
-			// Deleteing all of the outgoing edges
-			oNode->second.clear();
-			// Deleteing all of the incoming edges
-			for (auto i = graph_.begin(); i != graph_.end(); ++i) {
-				if (i->second.size() == 0) {
-					continue;
-				}
-				for (auto j = i->second.begin(); j != i->second.end();) {
-					if (*((j->first).lock()) == value) {
-						i->second.erase(j++);
-					}
-					else {
-						j++;
-					}
-				}
-			}
-			// Delete the node itself.
-			graph_.erase(oNode);
-			return (graph_.find(value) == graph_.end());
+		[[nodiscard]] auto begin() const -> iterator {
+			return iterator{this, 0, 0};
 		}
 
-		auto erase_edge(N const& src, N const& dst, E const& weight) -> bool {
-			if (!is_node(src) || !is_node(dst)) {
-				throw std::runtime_error("Cannot call gdwg::graph<N, E>::erase_edge on src or dst "
-				                         "if they don't exist in the graph");
-			}
-			auto sNode = graph_.find(src);
-			for (auto it = sNode->second.begin(); it != sNode->second.end(); ++it) {
-				if ((*it->first.lock() == dst) && (it->second == weight)) {
-					sNode->second.erase(it);
-					return true;
-				}
-			}
-			return false;
+		[[nodiscard]] auto end() const -> iterator {
+			return iterator{this, nodes_.size(), dsts_.size()};
 		}
 
-		auto erase_edge(iterator i) -> iterator {
-			auto nextptr = i++;
-			auto b = erase_edge((*i).from, (*i).to, (*i).weight);
-
-			if (b) {
-				return nextptr;
+		// This function returns the dense ID of a node.
+		[[nodiscard]] auto node_id(N const& value) const -> id_type {
+			auto it = std::lower_bound(nodes_.begin(), nodes_.end(), value);
+			if (it == nodes_.end() || *it != value) {
+				throw std::runtime_error("Cannot call gdwg::frozen_graph<N, E>::node_id on a node "
+				                         "that doesn't exist");
 			}
-			return end();
+			return static_cast<id_type>(it - nodes_.begin());
 		}
 
-		auto erase_edge(iterator i, iterator s) -> iterator {
-			for (auto it = i; it != s; it++) {
-				erase_edge((*it).from, (*it).to, (*it).weight);
-			}
-			return s;
+		// This function returns the node with the given dense ID.
+		[[nodiscard]] auto node(id_type id) const -> N const& {
+			return nodes_[id];
 		}
 
-		auto clear() noexcept -> void {
-			graph_.clear();
+		[[nodiscard]] auto is_node(N const& value) const -> bool {
+			return std::binary_search(nodes_.begin(), nodes_.end(), value);
 		}
 
-		/***************************************
-		**                                    **
-		**            Accessors               **
-		**                                    **
-		***************************************/
-
-		// This function tells us if the node exists in the graph.
-		[[nodiscard]] auto is_node(N const& value) -> bool {
-			return (graph_.find(value) != graph_.end());
+		[[nodiscard]] auto empty() const noexcept -> bool {
+			return nodes_.empty();
 		}
 
-		// This function tells us if the graph is empty.
-		[[nodiscard]] auto empty() -> bool {
-			return graph_.empty();
+		[[nodiscard]] auto size() const noexcept -> int {
+			return static_cast<int>(nodes_.size());
 		}
 
-		// Function that returns total number of nodes for testing purposes.
-		[[nodiscard]] auto size() -> int {
-			return static_cast<int>(graph_.size());
+		[[nodiscard]] auto edge_count() const noexcept -> std::size_t {
+			return dsts_.size();
 		}
 
-		// This function tells us if a connection exists between src and dst.
-		[[nodiscard]] auto is_connected(N const& src, N const& dst) -> bool {
-			// error testing.
+		[[nodiscard]] auto is_connected(N const& src, N const& dst) const -> bool {
 			if (!is_node(src) || !is_node(dst)) {
-				throw std::runtime_error("Cannot call gdwg::graph<N, E>::is_connected if src or dst"
-				                         " node don't exist in the graph");
+				throw std::runtime_error("Cannot call gdwg::frozen_graph<N, E>::is_connected if src or "
+				                         "dst node don't exist in the graph");
 			}
-			// Get the key value pair related to src.
-			auto sNode = graph_.find(src);
-			// sNode->second is the set(value).
-			return ((sNode->second).find(dst) != (sNode->second).end());
+			auto [first, last] = edge_range(node_id(src), node_id(dst));
+			return first != last;
 		}
 
-		// This function returns a vector of all the nodes in the graph.
-		[[nodiscard]] auto nodes() -> std::vector<N> {
-			std::vector<N> v;
-			for (auto i = graph_.begin(); i != graph_.end(); ++i) {
-				v.emplace_back(*i->first);
-			}
-			return v;
+		[[nodiscard]] auto nodes() const -> std::vector<N> {
+			return nodes_;
 		}
 
-		// This function returns a vector of all the weight between 2 nodes.
-		[[nodiscard]] auto weights(N const& src, N const& dst) -> std::vector<E> {
+		[[nodiscard]] auto weights(N const& src, N const& dst) const -> std::vector<E> {
 			if (!is_node(src) || !is_node(dst)) {
-				throw std::runtime_error("Cannot call gdwg::graph<N, E>::weights if src or dst node"
-				                         " don't exist in the graph");
-			}
-			auto sNode = graph_.find(src)->second;
-			std::vector<E> v;
-			for (auto it = sNode.begin(); it != sNode.end(); ++it) {
-				if (*(it->first).lock() == dst) {
-					v.emplace_back(it->second);
-				}
-			}
-			return v;
-		}
-
-		// This function returns an iterator to an edge.
-		[[nodiscard]] auto find(N const& src, N const& dst, E const& weight) -> iterator {
-			auto srcNode = graph_.find(src);
-			// auto sNode = srcNode->second;
-			auto dNode = graph_.find(dst);
-			std::weak_ptr<N> weak1 = dNode->first;
-			std::pair<std::weak_ptr<N>, E> edge1(weak1, weight);
-			auto foundEdge = srcNode->second.find(edge1);
-			if (foundEdge == srcNode->second.end()) {
-				return end();
-			}
-			else {
-				return iterator{srcNode, graph_.end(), foundEdge};
+				throw std::runtime_error("Cannot call gdwg::frozen_graph<N, E>::weights if src or dst "
+				                         "node don't exist in the graph");
 			}
+			auto [first, last] = edge_range(node_id(src), node_id(dst));
+			return std::vector<E>(weights_.begin() + static_cast<std::ptrdiff_t>(first),
+			                      weights_.begin() + static_cast<std::ptrdiff_t>(last));
 		}
 
-		// This function returns a vector of all the nodes leaving src.
-		[[nodiscard]] auto connections(N const& src) -> std::vector<N> {
+		[[nodiscard]] auto connections(N const& src) const -> std::vector<N> {
 			if (!is_node(src)) {
-				throw std::runtime_error("Cannot call gdwg::graph<N, E>::connections if src doesn't"
-				                         " exist in the graph");
+				throw std::runtime_error("Cannot call gdwg::frozen_graph<N, E>::connections if src "
+				                         "doesn't exist in the graph");
 			}
-			auto sNode = graph_.find(src)->second;
+			auto id = node_id(src);
 			std::vector<N> v;
-			for (auto it = sNode.begin(); it != sNode.end(); ++it) {
-				// To avoid duplicates we do a binary search(very fast).
-				if (!std::binary_search(v.begin(), v.end(), *(it->first.lock()))) {
-					v.emplace_back(*(it->first.lock()));
+			for (auto e = offsets_[id]; e < offsets_[id + 1]; ++e) {
+				// Edges are sorted by destination so duplicates are always adjacent.
+				if (e == offsets_[id] || dsts_[e] != dsts_[e - 1]) {
+					v.emplace_back(nodes_[dsts_[e]]);
 				}
 			}
 			return v;
 		}
-		/*
-		[[nodiscard]] auto operator==(graph const& other) -> bool {
-		   auto a = other.graph_.begin();
-		   while (a !=)
+
+		// Raw CSR arrays for callers that want to walk the snapshot by ID.
+		[[nodiscard]] auto offsets() const noexcept -> std::vector<std::size_t> const& {
+			return offsets_;
 		}
-		*/
-		friend auto operator<<(std::ostream& os, graph const& g) -> std::ostream& {
-			for (auto iter = g.graph_.begin(); iter != g.graph_.end(); ++iter) {
-				os << *(iter->first) << "(" << '\n';
-				for (auto it = iter->second.begin(); it != iter->second.end(); ++it) {
-					os << '\t' << *(it->first.lock()) << " | " << (it->second) << '\n';
+
+		[[nodiscard]] auto destinations() const noexcept -> std::vector<id_type> const& {
+			return dsts_;
+		}
+
+		[[nodiscard]] auto edge_weights() const noexcept -> std::vector<E> const& {
+			return weights_;
+		}
+
+		friend auto operator<<(std::ostream& os, frozen_graph const& g) -> std::ostream& {
+			for (auto i = std::size_t{0}; i < g.nodes_.size(); ++i) {
+				os << g.nodes_[i] << "(" << '\n';
+				for (auto e = g.offsets_[i]; e < g.offsets_[i + 1]; ++e) {
+					os << '\t' << g.nodes_[g.dsts_[e]] << " | " << g.weights_[e] << '\n';
 				}
 				os << ")" << '\n';
 			}
@@ -482,7 +3086,19 @@ namespace gdwg {
 		}
 
 	private:
-		std::map<std::shared_ptr<N>, destination_node, mapComparator> graph_;
+		// Returns the [first, last) edge indices going from src to dst.
+		auto edge_range(id_type src, id_type dst) const -> std::pair<std::size_t, std::size_t> {
+			auto first = dsts_.begin() + static_cast<std::ptrdiff_t>(offsets_[src]);
+			auto last = dsts_.begin() + static_cast<std::ptrdiff_t>(offsets_[src + 1]);
+			auto [lo, hi] = std::equal_range(first, last, dst);
+			return {static_cast<std::size_t>(lo - dsts_.begin()),
+			        static_cast<std::size_t>(hi - dsts_.begin())};
+		}
+
+		std::vector<N> nodes_; // Sorted nodes, indexed by dense ID
+		std::vector<std::size_t> offsets_ = {0}; // Start of each node's edges, plus one past the end
+		std::vector<id_type> dsts_; // Destination ID of each edge
+		std::vector<E> weights_; // Weight of each edge
 	};
 } // namespace gdwg
 
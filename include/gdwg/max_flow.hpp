@@ -0,0 +1,208 @@
+#ifndef GDWG_MAX_FLOW_HPP
+#define GDWG_MAX_FLOW_HPP
+#include <algorithm>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <numeric>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "gdwg/graph.hpp"
+#include "gdwg/traversal.hpp"
+
+// Maximum flow over gdwg::graph by push-relabel. A capacity view turns the weight of each edge
+// into its capacity; by default the weight is the capacity. Parallel edges each carry their
+// own flow.
+namespace gdwg {
+	// The default capacity view.
+	struct weight_capacity {
+		template<typename E>
+		auto operator()(E const& weight) const -> E {
+			return weight;
+		}
+	};
+
+	template<typename N, typename C>
+	struct maximum_flow {
+		C value = C{}; // Total flow from src to dst
+		std::vector<C> edge_flow; // Flow along each edge, in iteration order
+		std::vector<N> source_side; // The nodes on src's side of a minimum cut, sorted
+	};
+
+	namespace detail {
+		// The residual graph push-relabel works on. Every edge becomes an arc that can carry
+		// what is left of its capacity, paired with an arc the other way that can undo its
+		// flow. The arcs of each node are stored together.
+		template<typename C>
+		struct residual_network {
+			std::vector<std::size_t> first; // The arcs of node u are [first[u], first[u + 1])
+			std::vector<std::size_t> head; // Where each arc goes
+			std::vector<std::size_t> pair; // The arc going the other way
+			std::vector<C> residual; // What each arc can still carry
+			std::vector<std::size_t> forward; // The arc of each edge
+		};
+
+		template<typename C, typename G, typename Capacity>
+		auto make_residual_network(G const& g, std::vector<edge_ref<G>> const& edges, Capacity const& capacity)
+		   -> residual_network<C> {
+			auto net = residual_network<C>{};
+			net.first.assign(g.id_bound() + 1, 0);
+			for (auto const& edge : edges) {
+				++net.first[index<G>(edge.from) + 1];
+				++net.first[index<G>(edge.to) + 1];
+			}
+			std::partial_sum(net.first.begin(), net.first.end(), net.first.begin());
+			auto next = std::vector<std::size_t>(net.first.begin(), net.first.end() - 1);
+			net.head.resize(2 * edges.size());
+			net.pair.resize(2 * edges.size());
+			net.residual.resize(2 * edges.size());
+			net.forward.resize(edges.size());
+			for (auto e = std::size_t{0}; e < edges.size(); ++e) {
+				auto cap = static_cast<C>(std::invoke(capacity, *edges[e].weight));
+				if (cap < C{}) {
+					throw std::runtime_error("Cannot call gdwg::max_flow on a graph with negative "
+					                         "capacities");
+				}
+				auto u = index<G>(edges[e].from);
+				auto v = index<G>(edges[e].to);
+				auto a = next[u]++;
+				auto b = next[v]++;
+				net.head[a] = v;
+				net.head[b] = u;
+				net.pair[a] = b;
+				net.pair[b] = a;
+				net.residual[a] = cap;
+				net.residual[b] = C{};
+				net.forward[e] = a;
+			}
+			return net;
+		}
+
+		// FIFO push-relabel with the gap heuristic. Runs until no node but s and t holds excess,
+		// so the preflow left behind is a flow. Returns the excess of every node.
+		template<typename C>
+		auto push_relabel(residual_network<C>& net, std::size_t s, std::size_t t) -> std::vector<C> {
+			auto const n = net.first.size() - 1;
+			auto height = std::vector<std::size_t>(n, 0);
+			auto count = std::vector<std::size_t>(2 * n + 1, 0); // Nodes at each height
+			auto excess = std::vector<C>(n, C{});
+			auto current = std::vector<std::size_t>(net.first.begin(), net.first.end() - 1);
+			auto active = std::deque<std::size_t>{};
+			auto push = [&](std::size_t a, std::size_t u, C amount) {
+				auto v = net.head[a];
+				net.residual[a] -= amount;
+				net.residual[net.pair[a]] += amount;
+				excess[u] -= amount;
+				if (excess[v] == C{} && v != s && v != t) {
+					active.push_back(v);
+				}
+				excess[v] += amount;
+			};
+			auto relabel = [&](std::size_t u) {
+				auto old = height[u];
+				auto lowest = 2 * n;
+				for (auto a = net.first[u]; a < net.first[u + 1]; ++a) {
+					if (net.residual[a] > C{}) {
+						lowest = std::min(lowest, height[net.head[a]] + 1);
+					}
+				}
+				--count[old];
+				height[u] = lowest;
+				++count[lowest];
+				current[u] = net.first[u];
+				// Nothing above an empty height below n can reach t any more, so lift it all
+				// straight past s.
+				if (count[old] == 0 && old < n) {
+					for (auto w = std::size_t{0}; w < n; ++w) {
+						if (old < height[w] && height[w] < n && w != s) {
+							--count[height[w]];
+							height[w] = n + 1;
+							++count[height[w]];
+							current[w] = net.first[w];
+						}
+					}
+				}
+			};
+			height[s] = n;
+			count[0] = n - 1;
+			count[n] = 1;
+			for (auto a = net.first[s]; a < net.first[s + 1]; ++a) {
+				if (net.residual[a] > C{}) {
+					push(a, s, net.residual[a]);
+				}
+			}
+			while (!active.empty()) {
+				auto u = active.front();
+				active.pop_front();
+				while (excess[u] > C{}) {
+					if (current[u] == net.first[u + 1]) {
+						relabel(u);
+						continue;
+					}
+					auto a = current[u];
+					if (net.residual[a] > C{} && height[u] == height[net.head[a]] + 1) {
+						push(a, u, std::min(excess[u], net.residual[a]));
+					}
+					else {
+						++current[u];
+					}
+				}
+			}
+			return excess;
+		}
+	} // namespace detail
+
+	// The maximum flow from src to dst where each edge can carry capacity(weight). The
+	// adjacency is read in place through node IDs into one flat residual network, so no edge
+	// is copied out of the graph.
+	template<typename N, typename E, typename Allocator, typename Lookup, typename Capacity = weight_capacity>
+	requires std::is_arithmetic_v<std::remove_cvref_t<std::invoke_result_t<Capacity const&, E const&>>>
+	auto max_flow(graph<N, E, Allocator, Lookup> const& g, N const& src, N const& dst, Capacity capacity = {})
+	   -> maximum_flow<N, std::remove_cvref_t<std::invoke_result_t<Capacity const&, E const&>>> {
+		using G = graph<N, E, Allocator, Lookup>;
+		using C = std::remove_cvref_t<std::invoke_result_t<Capacity const&, E const&>>;
+		if (!g.is_node(src) || !g.is_node(dst)) {
+			throw std::runtime_error("Cannot call gdwg::max_flow if src or dst node don't exist in "
+			                         "the graph");
+		}
+		if (src == dst) {
+			throw std::runtime_error("Cannot call gdwg::max_flow with the same node as src and dst");
+		}
+		auto const edges = detail::edges_in_order(g);
+		auto net = detail::make_residual_network<C>(g, edges, capacity);
+		auto s = detail::index<G>(g.node_id(src));
+		auto t = detail::index<G>(g.node_id(dst));
+		auto excess = detail::push_relabel(net, s, t);
+
+		auto result = maximum_flow<N, C>{};
+		result.value = excess[t];
+		result.edge_flow.reserve(edges.size());
+		for (auto a : net.forward) {
+			// The paired arc can undo exactly what the edge carries.
+			result.edge_flow.push_back(net.residual[net.pair[a]]);
+		}
+		// What src can still reach in the residual network is its side of a minimum cut.
+		auto seen = std::vector<char>(g.id_bound(), 0);
+		auto queue = std::vector<std::size_t>{s};
+		seen[s] = 1;
+		for (auto head = std::size_t{0}; head < queue.size(); ++head) {
+			auto u = queue[head];
+			for (auto a = net.first[u]; a < net.first[u + 1]; ++a) {
+				if (net.residual[a] > C{} && !seen[net.head[a]]) {
+					seen[net.head[a]] = 1;
+					queue.push_back(net.head[a]);
+				}
+			}
+		}
+		for (auto u : queue) {
+			result.source_side.push_back(g.node(static_cast<typename G::id_type>(u)));
+		}
+		std::sort(result.source_side.begin(), result.source_side.end());
+		return result;
+	}
+} // namespace gdwg
+
+#endif // GDWG_MAX_FLOW_HPP
@@ -0,0 +1,217 @@
+#ifndef GDWG_SHORTEST_PATH_HPP
+#define GDWG_SHORTEST_PATH_HPP
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <map>
+#include <queue>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "gdwg/graph.hpp"
+
+// Single source shortest paths over gdwg::graph. Both algorithms walk the graph's own
+// adjacency through node IDs, so nothing is copied out of the graph first.
+namespace gdwg {
+	template<typename N, typename E>
+	struct shortest_paths {
+		std::map<N, E> distance; // Distance from the source to every node it can reach
+		std::map<N, N> predecessor; // Node before each reached node (except the source) on its path
+	};
+
+	namespace detail {
+		// Calls f(weight) for every edge in the graph.
+		template<typename N, typename E, typename Allocator, typename Lookup, typename F>
+		auto for_each_weight(graph<N, E, Allocator, Lookup> const& g, F f) -> void {
+			for (auto i = std::size_t{0}; i < g.id_bound(); ++i) {
+				auto id = static_cast<typename graph<N, E, Allocator, Lookup>::id_type>(i);
+				if (g.is_node(id)) {
+					for (auto const& edge : g.out_edges(id)) {
+						f(edge.second);
+					}
+				}
+			}
+		}
+
+		// Checks that src is in the graph and no edge has a negative weight.
+		template<typename N, typename E, typename Allocator, typename Lookup>
+		auto check_shortest_path_input(graph<N, E, Allocator, Lookup> const& g, N const& src) -> void {
+			if (!g.is_node(src)) {
+				throw std::runtime_error("Cannot call a gdwg shortest path algorithm if src doesn't "
+				                         "exist in the graph");
+			}
+			if constexpr (std::is_signed_v<E>) {
+				for_each_weight(g, [](E const& weight) {
+					if (weight < E{}) {
+						throw std::runtime_error("Cannot call a gdwg shortest path algorithm on a "
+						                         "graph with negative edge weights");
+					}
+				});
+			}
+		}
+
+		// Turns distances by ID into the result maps.
+		// The predecessor of each node is the first one a breadth first search over the edges
+		// that lie on shortest paths reaches it from. That only depends on the distances, so
+		// every algorithm that finds the same distances returns the same tree too.
+		template<typename N, typename E, typename Allocator, typename Lookup>
+		auto make_shortest_paths(graph<N, E, Allocator, Lookup> const& g,
+		                         typename graph<N, E, Allocator, Lookup>::id_type src,
+		                         std::vector<E> const& dist) -> shortest_paths<N, E> {
+			using G = graph<N, E, Allocator, Lookup>;
+			auto result = shortest_paths<N, E>{};
+			auto seen = std::vector<char>(dist.size(), 0);
+			auto queue = std::vector<id_of<G>>{src};
+			seen[index<G>(src)] = 1;
+			for (auto head = std::size_t{0}; head < queue.size(); ++head) {
+				auto u = queue[head];
+				for (auto const& [v, w] : g.out_edges(u)) {
+					if (!seen[index<G>(v)] && static_cast<E>(dist[index<G>(u)] + w) == dist[index<G>(v)]) {
+						seen[index<G>(v)] = 1;
+						result.predecessor.emplace(g.node(v), g.node(u));
+						queue.push_back(v);
+					}
+				}
+			}
+			for (auto i = queue.begin(); i != queue.end(); ++i) {
+				result.distance.emplace(g.node(*i), dist[index<G>(*i)]);
+			}
+			return result;
+		}
+	} // namespace detail
+
+	// Dijkstra's algorithm with a binary heap. Edge weights must not be negative.
+	template<typename N, typename E, typename Allocator, typename Lookup>
+	requires std::is_arithmetic_v<E>
+	auto dijkstra(graph<N, E, Allocator, Lookup> const& g, N const& src) -> shortest_paths<N, E> {
+		using G = graph<N, E, Allocator, Lookup>;
+		using id_type = typename G::id_type;
+		detail::check_shortest_path_input(g, src);
+		auto s = g.node_id(src);
+		auto dist = std::vector<E>(g.id_bound(), std::numeric_limits<E>::max());
+		auto queue =
+		   std::priority_queue<std::pair<E, id_type>, std::vector<std::pair<E, id_type>>, std::greater<>>{};
+		dist[detail::index<G>(s)] = E{};
+		queue.emplace(E{}, s);
+		while (!queue.empty()) {
+			auto [d, u] = queue.top();
+			queue.pop();
+			// Skip queue entries that were beaten after they were pushed.
+			if (dist[detail::index<G>(u)] < d) {
+				continue;
+			}
+			for (auto const& [v, w] : g.out_edges(u)) {
+				auto next = static_cast<E>(d + w);
+				if (next < dist[detail::index<G>(v)]) {
+					dist[detail::index<G>(v)] = next;
+					queue.emplace(next, v);
+				}
+			}
+		}
+		return detail::make_shortest_paths(g, s, dist);
+	}
+
+	// Parallel delta-stepping. Nodes are kept in buckets of width delta. Each bucket is emptied
+	// by relaxing its light edges (weight <= delta) across all threads until no node falls back
+	// into it, and then the heavy edges of everything it held are relaxed once.
+	// A delta of zero picks the average edge weight, and zero threads uses every core.
+	// The result is exactly the one dijkstra() returns. Edge weights must not be negative.
+	template<typename N, typename E, typename Allocator, typename Lookup>
+	requires std::is_arithmetic_v<E>
+	auto delta_stepping(graph<N, E, Allocator, Lookup> const& g,
+	                    N const& src,
+	                    E delta = E{},
+	                    unsigned threads = 0) -> shortest_paths<N, E> {
+		using G = graph<N, E, Allocator, Lookup>;
+		using id_type = typename G::id_type;
+		detail::check_shortest_path_input(g, src);
+		auto s = g.node_id(src);
+		threads = detail::thread_count(threads);
+		if (!(delta > E{})) {
+			auto total = 0.0L;
+			auto count = std::size_t{0};
+			detail::for_each_weight(g, [&](E const& weight) {
+				total += static_cast<long double>(weight);
+				++count;
+			});
+			delta = count == 0 ? E{} : static_cast<E>(total / static_cast<long double>(count));
+			if (!(delta > E{})) {
+				delta = E{1};
+			}
+		}
+
+		auto dist = std::vector<std::atomic<E>>(g.id_bound());
+		for (auto i = dist.begin(); i != dist.end(); ++i) {
+			i->store(std::numeric_limits<E>::max(), std::memory_order_relaxed);
+		}
+		dist[detail::index<G>(s)].store(E{}, std::memory_order_relaxed);
+		auto bucket_of = [delta](E d) { return static_cast<std::size_t>(d / delta); };
+		// Bucket number -> nodes waiting in it. A node can sit in a bucket it has since left;
+		// those entries are skipped when the bucket is taken.
+		auto buckets = std::map<std::size_t, std::vector<id_type>>{{0, {s}}};
+
+		// Relaxes the light or heavy edges of every node in frontier, spread over the threads,
+		// and files every node that got closer into its new bucket.
+		auto relax_all = [&](std::vector<id_type> const& frontier, bool light) {
+			auto workers = detail::worker_count(threads, frontier.size());
+			auto moved = std::vector<std::vector<std::pair<id_type, E>>>(workers);
+			auto work = [&](std::size_t worker, std::size_t first, std::size_t last) {
+				for (auto i = first; i < last; ++i) {
+					auto u = frontier[i];
+					auto d = dist[detail::index<G>(u)].load(std::memory_order_relaxed);
+					for (auto const& [v, w] : g.out_edges(u)) {
+						if ((w <= delta) != light) {
+							continue;
+						}
+						auto next = static_cast<E>(d + w);
+						auto& slot = dist[detail::index<G>(v)];
+						auto current = slot.load(std::memory_order_relaxed);
+						while (next < current) {
+							if (slot.compare_exchange_weak(current, next, std::memory_order_relaxed)) {
+								moved[worker].emplace_back(v, next);
+								break;
+							}
+						}
+					}
+				}
+			};
+			detail::parallel_for(workers, frontier.size(), work);
+			for (auto const& list : moved) {
+				for (auto const& [v, d] : list) {
+					buckets[bucket_of(d)].push_back(v);
+				}
+			}
+		};
+
+		while (!buckets.empty()) {
+			auto current = buckets.begin()->first;
+			auto settled = std::vector<id_type>{};
+			for (auto it = buckets.find(current); it != buckets.end(); it = buckets.find(current)) {
+				auto frontier = std::move(it->second);
+				buckets.erase(it);
+				std::sort(frontier.begin(), frontier.end());
+				frontier.erase(std::unique(frontier.begin(), frontier.end()), frontier.end());
+				std::erase_if(frontier, [&](id_type v) {
+					return bucket_of(dist[detail::index<G>(v)].load(std::memory_order_relaxed)) != current;
+				});
+				settled.insert(settled.end(), frontier.begin(), frontier.end());
+				relax_all(frontier, true);
+			}
+			std::sort(settled.begin(), settled.end());
+			settled.erase(std::unique(settled.begin(), settled.end()), settled.end());
+			relax_all(settled, false);
+		}
+
+		auto result = std::vector<E>(dist.size());
+		for (auto i = std::size_t{0}; i < dist.size(); ++i) {
+			result[i] = dist[i].load(std::memory_order_relaxed);
+		}
+		return detail::make_shortest_paths(g, s, result);
+	}
+} // namespace gdwg
+
+#endif // GDWG_SHORTEST_PATH_HPP
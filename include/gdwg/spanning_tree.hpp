@@ -0,0 +1,169 @@
+#ifndef GDWG_SPANNING_TREE_HPP
+#define GDWG_SPANNING_TREE_HPP
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <limits>
+#include <numeric>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "gdwg/graph.hpp"
+#include "gdwg/traversal.hpp"
+
+// Minimum spanning forests over gdwg::graph. Edge directions are ignored, so every weakly
+// connected component gets one tree. The edges are read by reference from the graph's own
+// adjacency, and only the ones chosen are copied out.
+//
+// Equal weights are ranked by iteration order, so no two edges tie and the forest is unique:
+// kruskal() and boruvka() always return the same one.
+namespace gdwg {
+	template<typename N, typename E>
+	struct spanning_forest {
+		std::vector<typename graph<N, E>::value_type> edges; // In iteration order
+		E weight = E{}; // Sum of the weights of the edges
+	};
+
+	namespace detail {
+		// Union by size with path halving.
+		class disjoint_sets {
+		public:
+			explicit disjoint_sets(std::size_t count)
+			: parent_(count)
+			, size_(count, 1) {
+				std::iota(parent_.begin(), parent_.end(), std::size_t{0});
+			}
+
+			auto find(std::size_t x) noexcept -> std::size_t {
+				while (parent_[x] != x) {
+					parent_[x] = parent_[parent_[x]];
+					x = parent_[x];
+				}
+				return x;
+			}
+
+			// Joins the sets of a and b. Returns false if they already were one.
+			auto unite(std::size_t a, std::size_t b) noexcept -> bool {
+				a = find(a);
+				b = find(b);
+				if (a == b) {
+					return false;
+				}
+				if (size_[a] < size_[b]) {
+					std::swap(a, b);
+				}
+				parent_[b] = a;
+				size_[a] += size_[b];
+				return true;
+			}
+
+		private:
+			std::vector<std::size_t> parent_;
+			std::vector<std::size_t> size_;
+		};
+
+		// Whether edge a ranks before edge b: by weight, then by place in iteration order.
+		template<typename Edges>
+		auto lighter(Edges const& edges, std::size_t a, std::size_t b) -> bool {
+			auto const& wa = *edges[a].weight;
+			auto const& wb = *edges[b].weight;
+			return wa < wb || (!(wb < wa) && a < b);
+		}
+
+		template<typename N, typename E, typename G>
+		auto make_spanning_forest(G const& g,
+		                          std::vector<edge_ref<G>> const& edges,
+		                          std::vector<std::size_t>& chosen) -> spanning_forest<N, E> {
+			std::sort(chosen.begin(), chosen.end());
+			auto forest = spanning_forest<N, E>{};
+			forest.edges.reserve(chosen.size());
+			for (auto e : chosen) {
+				auto const& edge = edges[e];
+				forest.edges.push_back({g.node(edge.from), g.node(edge.to), *edge.weight});
+				forest.weight += *edge.weight;
+			}
+			return forest;
+		}
+	} // namespace detail
+
+	// Kruskal's algorithm: the edges are taken lightest first, and each one is kept unless it
+	// would close a cycle.
+	template<typename N, typename E, typename Allocator, typename Lookup>
+	requires std::is_arithmetic_v<E>
+	auto kruskal(graph<N, E, Allocator, Lookup> const& g) -> spanning_forest<N, E> {
+		using G = graph<N, E, Allocator, Lookup>;
+		auto const edges = detail::edges_in_order(g);
+		auto order = std::vector<std::size_t>(edges.size());
+		std::iota(order.begin(), order.end(), std::size_t{0});
+		std::sort(order.begin(), order.end(), [&edges](std::size_t a, std::size_t b) {
+			return detail::lighter(edges, a, b);
+		});
+		auto sets = detail::disjoint_sets(g.id_bound());
+		auto chosen = std::vector<std::size_t>{};
+		for (auto e : order) {
+			if (sets.unite(detail::index<G>(edges[e].from), detail::index<G>(edges[e].to))) {
+				chosen.push_back(e);
+			}
+		}
+		return detail::make_spanning_forest<N, E>(g, edges, chosen);
+	}
+
+	// Borůvka's algorithm spread over threads. Every round each component picks the lightest
+	// edge leaving it and all the picked edges are joined, so each round at least halves the
+	// number of components. The threads split the edges between them and keep the lightest
+	// one for each component with a compare and swap. Zero threads uses every core.
+	template<typename N, typename E, typename Allocator, typename Lookup>
+	requires std::is_arithmetic_v<E>
+	auto boruvka(graph<N, E, Allocator, Lookup> const& g, unsigned threads = 0)
+	   -> spanning_forest<N, E> {
+		using G = graph<N, E, Allocator, Lookup>;
+		constexpr auto none = std::numeric_limits<std::size_t>::max();
+		auto const edges = detail::edges_in_order(g);
+		auto sets = detail::disjoint_sets(g.id_bound());
+		auto label = std::vector<std::size_t>(g.id_bound());
+		auto lightest = std::vector<std::atomic<std::size_t>>(g.id_bound());
+		// The edges that still join two components.
+		auto live = std::vector<std::size_t>(edges.size());
+		std::iota(live.begin(), live.end(), std::size_t{0});
+		auto chosen = std::vector<std::size_t>{};
+		while (true) {
+			for (auto u = std::size_t{0}; u < label.size(); ++u) {
+				label[u] = sets.find(u);
+				lightest[u].store(none, std::memory_order_relaxed);
+			}
+			std::erase_if(live, [&](std::size_t e) {
+				return label[detail::index<G>(edges[e].from)] == label[detail::index<G>(edges[e].to)];
+			});
+			if (live.empty()) {
+				break;
+			}
+			auto workers = detail::worker_count(detail::thread_count(threads), live.size());
+			detail::parallel_for(workers, live.size(), [&](std::size_t, std::size_t first, std::size_t last) {
+				for (auto i = first; i < last; ++i) {
+					auto e = live[i];
+					for (auto u : {edges[e].from, edges[e].to}) {
+						auto& best = lightest[label[detail::index<G>(u)]];
+						auto current = best.load(std::memory_order_relaxed);
+						while ((current == none || detail::lighter(edges, e, current))
+						       && !best.compare_exchange_weak(current, e, std::memory_order_relaxed))
+						{
+						}
+					}
+				}
+			});
+			// No two edges tie, so the picked edges can't make a cycle. An edge picked by both
+			// of its components is only joined once.
+			for (auto const& best : lightest) {
+				auto e = best.load(std::memory_order_relaxed);
+				if (e != none
+				    && sets.unite(detail::index<G>(edges[e].from), detail::index<G>(edges[e].to))) {
+					chosen.push_back(e);
+				}
+			}
+		}
+		return detail::make_spanning_forest<N, E>(g, edges, chosen);
+	}
+} // namespace gdwg
+
+#endif // GDWG_SPANNING_TREE_HPP
@@ -0,0 +1,434 @@
+#ifndef GDWG_TEXT_HPP
+#define GDWG_TEXT_HPP
+#include <algorithm>
+#include <charconv>
+#include <concepts>
+#include <cstddef>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <istream>
+#include <iterator>
+#include <optional>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define GDWG_TEXT_HAS_FD 1
+#endif
+
+#include "gdwg/graph.hpp"
+
+// Text export and import for gdwg::graph, in the format operator<< writes: one block per node
+// in node order,
+//     src(
+//     	dst | weight
+//     )
+// with the node's edges in iteration order.
+//
+// Both directions go through one fixed size buffer, so neither the text of a whole graph nor
+// of a whole stream is held at once. A text_codec decides how a type is written and read:
+//     static auto format(T const& value, std::string& out) -> void; // append the text
+//     static auto parse(std::string_view text) -> T;
+// The default one goes through operator<< and operator>>. Numbers and strings have faster
+// ones that write exactly what operator<< does with the default formatting. A node's text
+// can't hold a newline or " | ", and a weight's text can't hold a newline.
+namespace gdwg {
+	template<typename T>
+	struct text_codec {
+		static auto format(T const& value, std::string& out) -> void {
+			auto os = std::ostringstream{};
+			os << value;
+			out += os.view();
+		}
+
+		static auto parse(std::string_view text) -> T {
+			auto is = std::istringstream(std::string(text));
+			auto value = T{};
+			is >> value;
+			if (is.fail() || is.get() != std::istringstream::traits_type::eof()) {
+				throw std::runtime_error("Cannot read a gdwg::graph value from \"" + std::string(text)
+				                         + "\"");
+			}
+			return value;
+		}
+	};
+
+	namespace detail {
+		// Numbers that operator<< writes as numbers, rather than as characters or as 0 and 1.
+		template<typename T>
+		concept text_number =
+		   std::floating_point<T>
+		   || (std::integral<T> && !std::same_as<T, bool> && !std::same_as<T, char>
+		       && !std::same_as<T, signed char> && !std::same_as<T, unsigned char>
+		       && !std::same_as<T, wchar_t> && !std::same_as<T, char8_t>
+		       && !std::same_as<T, char16_t> && !std::same_as<T, char32_t>);
+	} // namespace detail
+
+	// Floating point values are written like %g with six digits, which is also what operator<<
+	// writes, so they round trip no more exactly than through operator<<.
+	template<detail::text_number T>
+	struct text_codec<T> {
+		static auto format(T value, std::string& out) -> void {
+			char digits[64];
+			auto* end = digits;
+			if constexpr (std::floating_point<T>) {
+				end = std::to_chars(std::begin(digits), std::end(digits), value, std::chars_format::general, 6).ptr;
+			}
+			else {
+				end = std::to_chars(std::begin(digits), std::end(digits), value).ptr;
+			}
+			out.append(digits, end);
+		}
+
+		static auto parse(std::string_view text) -> T {
+			auto value = T{};
+			auto const* last = text.data() + text.size();
+			auto [end, error] = std::from_chars(text.data(), last, value);
+			if (error != std::errc{} || end != last) {
+				throw std::runtime_error("Cannot read a gdwg::graph value from \"" + std::string(text)
+				                         + "\"");
+			}
+			return value;
+		}
+	};
+
+	template<>
+	struct text_codec<std::string> {
+		static auto format(std::string const& value, std::string& out) -> void {
+			out += value;
+		}
+
+		static auto parse(std::string_view text) -> std::string {
+			return std::string(text);
+		}
+	};
+
+	namespace detail {
+		// The buffer is handed on whenever it holds at least this much text.
+		inline constexpr std::size_t text_buffer_size = std::size_t{1} << 20;
+		// Texts are only split for parallel parsing into pieces at least this big.
+		inline constexpr std::size_t min_text_piece = std::size_t{1} << 16;
+
+		[[noreturn]] inline auto malformed_text() -> void {
+			throw std::runtime_error("Cannot read a gdwg::graph from text that is not in the format "
+			                         "operator<< writes");
+		}
+
+		// Turns whole lines of text into the nodes and edges they describe. A block can span
+		// several calls to feed().
+		template<typename N, typename E, typename NodeCodec, typename WeightCodec>
+		class text_parser {
+		public:
+			// Parses every line in lines. Only the last one may be missing its newline.
+			auto feed(std::string_view lines) -> void {
+				while (!lines.empty()) {
+					auto end = std::min(lines.find('\n'), lines.size());
+					parse_line(lines.substr(0, end));
+					lines.remove_prefix(std::min(end + 1, lines.size()));
+				}
+			}
+
+			// Throws if the text stopped inside a block.
+			auto finish() const -> void {
+				if (src_) {
+					malformed_text();
+				}
+			}
+
+			// Moves what has been parsed so far into g. A well formed text has a block for every
+			// node, but an edge can come before the block of its destination.
+			template<typename Allocator, typename Lookup>
+			auto drain(graph<N, E, Allocator, Lookup>& g) -> void {
+				for (auto const& node : nodes_) {
+					g.insert_node(node);
+				}
+				for (auto const& edge : edges_) {
+					g.insert_node(edge.to);
+				}
+				g.insert_edges(edges_.begin(), edges_.end());
+				nodes_.clear();
+				edges_.clear();
+			}
+
+		private:
+			auto parse_line(std::string_view line) -> void {
+				if (!src_) {
+					if (line.empty() || line.back() != '(') {
+						malformed_text();
+					}
+					src_ = NodeCodec::parse(line.substr(0, line.size() - 1));
+					nodes_.push_back(*src_);
+				}
+				// A line that is just ")" can only ever end a block.
+				else if (line == ")") {
+					src_.reset();
+				}
+				else {
+					auto bar = line.find(" | ");
+					if (line.empty() || line.front() != '\t' || bar == std::string_view::npos) {
+						malformed_text();
+					}
+					edges_.push_back({*src_,
+					                  NodeCodec::parse(line.substr(1, bar - 1)),
+					                  WeightCodec::parse(line.substr(bar + 3))});
+				}
+			}
+
+			std::optional<N> src_; // The node whose block is open
+			std::vector<N> nodes_;
+			std::vector<typename graph<N, E>::value_type> edges_;
+		};
+
+		// Writes g a buffer at a time through write(std::string_view).
+		template<typename NodeCodec, typename WeightCodec, typename G, typename Write>
+		auto write_text_through(G const& g, Write write) -> void {
+			auto buffer = std::string{};
+			buffer.reserve(text_buffer_size);
+			for (auto const& node : g.nodes_view()) {
+				NodeCodec::format(node, buffer);
+				buffer += "(\n";
+				for (auto const& [dst, weight] : g.out_edges(node)) {
+					buffer += '\t';
+					NodeCodec::format(dst, buffer);
+					buffer += " | ";
+					WeightCodec::format(weight, buffer);
+					buffer += '\n';
+					if (buffer.size() >= text_buffer_size) {
+						write(std::string_view(buffer));
+						buffer.clear();
+					}
+				}
+				buffer += ")\n";
+				if (buffer.size() >= text_buffer_size) {
+					write(std::string_view(buffer));
+					buffer.clear();
+				}
+			}
+			if (!buffer.empty()) {
+				write(std::string_view(buffer));
+			}
+		}
+
+		// Reads a graph a buffer at a time through read(char* data, std::size_t size), which
+		// returns how much it read and 0 at the end.
+		template<typename N, typename E, typename NodeCodec, typename WeightCodec, typename Read>
+		auto read_text_through(Read read) -> graph<N, E> {
+			auto g = graph<N, E>{};
+			auto parser = text_parser<N, E, NodeCodec, WeightCodec>{};
+			auto buffer = std::string(text_buffer_size, '\0');
+			auto kept = std::size_t{0}; // The unfinished line at the start of the buffer
+			while (true) {
+				// Make room for a line longer than the buffer.
+				if (kept == buffer.size()) {
+					buffer.resize(buffer.size() * 2);
+				}
+				auto got = read(buffer.data() + kept, buffer.size() - kept);
+				if (got == 0) {
+					break;
+				}
+				auto filled = kept + got;
+				auto last = std::string_view(buffer.data(), filled).rfind('\n');
+				if (last == std::string_view::npos) {
+					kept = filled;
+					continue;
+				}
+				parser.feed(std::string_view(buffer.data(), last + 1));
+				parser.drain(g);
+				kept = filled - (last + 1);
+				std::memmove(buffer.data(), buffer.data() + last + 1, kept);
+			}
+			parser.feed(std::string_view(buffer.data(), kept));
+			parser.finish();
+			parser.drain(g);
+			return g;
+		}
+
+		// Splits text into at most pieces parts that each start at a block. Returns where each
+		// part starts, followed by the end of the text.
+		inline auto split_blocks(std::string_view text, std::size_t pieces) -> std::vector<std::size_t> {
+			auto bounds = std::vector<std::size_t>{0};
+			for (auto p = std::size_t{1}; p < pieces; ++p) {
+				auto from = std::max(bounds.back(), text.size() / pieces * p);
+				auto end = text.find("\n)\n", from == 0 ? 0 : from - 1);
+				if (end == std::string_view::npos) {
+					break;
+				}
+				bounds.push_back(end + 3);
+			}
+			bounds.push_back(text.size());
+			return bounds;
+		}
+
+#ifdef GDWG_TEXT_HAS_FD
+		// A whole file mapped read only, unmapped again on destruction.
+		class text_mapping {
+		public:
+			explicit text_mapping(std::filesystem::path const& path) {
+				auto fd = ::open(path.c_str(), O_RDONLY);
+				if (fd < 0) {
+					throw std::runtime_error("Cannot open " + path.string() + " as a gdwg text graph");
+				}
+				struct stat info {};
+				auto* mapping = MAP_FAILED;
+				if (::fstat(fd, &info) == 0) {
+					size_ = static_cast<std::size_t>(info.st_size);
+					mapping = size_ == 0 ? nullptr : ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+				}
+				::close(fd);
+				if (mapping == MAP_FAILED) {
+					throw std::runtime_error("Cannot map " + path.string() + " as a gdwg text graph");
+				}
+				mapping_ = mapping;
+			}
+
+			text_mapping(text_mapping const&) = delete;
+			auto operator=(text_mapping const&) -> text_mapping& = delete;
+
+			~text_mapping() {
+				if (mapping_ != nullptr) {
+					::munmap(mapping_, size_);
+				}
+			}
+
+			[[nodiscard]] auto text() const noexcept -> std::string_view {
+				return std::string_view(static_cast<char const*>(mapping_), size_);
+			}
+
+		private:
+			void* mapping_ = nullptr;
+			std::size_t size_ = 0;
+		};
+#endif
+	} // namespace detail
+
+	// Writes g as operator<< would, a buffer at a time.
+	template<typename N,
+	         typename E,
+	         typename NodeCodec = text_codec<N>,
+	         typename WeightCodec = text_codec<E>,
+	         typename Allocator,
+	         typename Lookup>
+	auto write_text(graph<N, E, Allocator, Lookup> const& g, std::ostream& os) -> void {
+		detail::write_text_through<NodeCodec, WeightCodec>(g, [&os](std::string_view text) {
+			os.write(text.data(), static_cast<std::streamsize>(text.size()));
+		});
+		if (!os) {
+			throw std::runtime_error("Cannot write a gdwg::graph to a stream that failed");
+		}
+	}
+
+	// Reads a graph written by write_text() or operator<<, a buffer at a time.
+	template<typename N, typename E, typename NodeCodec = text_codec<N>, typename WeightCodec = text_codec<E>>
+	auto read_text(std::istream& is) -> graph<N, E> {
+		return detail::read_text_through<N, E, NodeCodec, WeightCodec>(
+		   [&is](char* data, std::size_t size) -> std::size_t {
+			   is.read(data, static_cast<std::streamsize>(size));
+			   return static_cast<std::size_t>(is.gcount());
+		   });
+	}
+
+#ifdef GDWG_TEXT_HAS_FD
+	// The same, straight to a file descriptor, which is left open.
+	template<typename N,
+	         typename E,
+	         typename NodeCodec = text_codec<N>,
+	         typename WeightCodec = text_codec<E>,
+	         typename Allocator,
+	         typename Lookup>
+	auto write_text(graph<N, E, Allocator, Lookup> const& g, int fd) -> void {
+		detail::write_text_through<NodeCodec, WeightCodec>(g, [fd](std::string_view text) {
+			while (!text.empty()) {
+				auto wrote = ::write(fd, text.data(), text.size());
+				if (wrote < 0 && errno != EINTR) {
+					throw std::runtime_error("Cannot write a gdwg::graph to a file descriptor that "
+					                         "failed");
+				}
+				text.remove_prefix(static_cast<std::size_t>(std::max<decltype(wrote)>(wrote, 0)));
+			}
+		});
+	}
+
+	template<typename N, typename E, typename NodeCodec = text_codec<N>, typename WeightCodec = text_codec<E>>
+	auto read_text(int fd) -> graph<N, E> {
+		return detail::read_text_through<N, E, NodeCodec, WeightCodec>(
+		   [fd](char* data, std::size_t size) -> std::size_t {
+			   while (true) {
+				   auto got = ::read(fd, data, size);
+				   if (got >= 0) {
+					   return static_cast<std::size_t>(got);
+				   }
+				   if (errno != EINTR) {
+					   throw std::runtime_error("Cannot read a gdwg::graph from a file descriptor "
+					                            "that failed");
+				   }
+			   }
+		   });
+	}
+#endif
+
+	// Parses a whole text spread over threads. The text is split where blocks end, each piece
+	// is parsed on its own thread, and the pieces go into the graph in order. Zero threads
+	// uses every core.
+	template<typename N, typename E, typename NodeCodec = text_codec<N>, typename WeightCodec = text_codec<E>>
+	auto parallel_parse_text(std::string_view text, unsigned threads = 0) -> graph<N, E> {
+		using parser_type = detail::text_parser<N, E, NodeCodec, WeightCodec>;
+		auto pieces = std::min<std::size_t>(detail::thread_count(threads),
+		                                    std::max<std::size_t>(1, text.size() / detail::min_text_piece));
+		auto const bounds = detail::split_blocks(text, pieces);
+		pieces = bounds.size() - 1;
+		auto parsers = std::vector<parser_type>(pieces);
+		// A worker can't throw past its thread, so it leaves the exception here instead.
+		auto errors = std::vector<std::exception_ptr>(pieces);
+		detail::parallel_for(pieces, pieces, [&](std::size_t, std::size_t first, std::size_t last) {
+			for (auto p = first; p < last; ++p) {
+				try {
+					parsers[p].feed(text.substr(bounds[p], bounds[p + 1] - bounds[p]));
+					parsers[p].finish();
+				} catch (...) {
+					errors[p] = std::current_exception();
+				}
+			}
+		});
+		for (auto const& error : errors) {
+			if (error) {
+				std::rethrow_exception(error);
+			}
+		}
+		auto g = graph<N, E>{};
+		for (auto& parser : parsers) {
+			parser.drain(g);
+		}
+		return g;
+	}
+
+	// Parses a whole file spread over threads. The file is mapped rather than read when it
+	// can be.
+	template<typename N, typename E, typename NodeCodec = text_codec<N>, typename WeightCodec = text_codec<E>>
+	auto parallel_read_text(std::filesystem::path const& path, unsigned threads = 0) -> graph<N, E> {
+#ifdef GDWG_TEXT_HAS_FD
+		auto const file = detail::text_mapping(path);
+		return parallel_parse_text<N, E, NodeCodec, WeightCodec>(file.text(), threads);
+#else
+		auto is = std::ifstream(path, std::ios::binary);
+		if (!is) {
+			throw std::runtime_error("Cannot open " + path.string() + " as a gdwg text graph");
+		}
+		auto const text = std::string(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+		return parallel_parse_text<N, E, NodeCodec, WeightCodec>(text, threads);
+#endif
+	}
+} // namespace gdwg
+
+#endif // GDWG_TEXT_HPP
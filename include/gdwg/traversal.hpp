@@ -0,0 +1,676 @@
+#ifndef GDWG_TRAVERSAL_HPP
+#define GDWG_TRAVERSAL_HPP
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "gdwg/graph.hpp"
+
+// Breadth first search, connected components and topological sort over gdwg::graph.
+// Every algorithm has a sequential version and a parallel_ one that returns exactly the same
+// result. Like the shortest path algorithms they walk the adjacency through node IDs, so no
+// edge set is copied. For the parallel ones zero threads uses every core.
+namespace gdwg {
+	namespace detail {
+		constexpr auto unreached = std::numeric_limits<std::size_t>::max();
+
+		template<typename T>
+		auto concatenate(std::vector<std::vector<T>>& parts) -> std::vector<T> {
+			auto all = std::vector<T>{};
+			for (auto& part : parts) {
+				all.insert(all.end(), part.begin(), part.end());
+			}
+			return all;
+		}
+
+		// Number of edges leaving u when forward, otherwise entering it. Parallel edges each
+		// count in both directions, so the two are measured the same way. The reverse index
+		// keeps one count per source, so the backward degree adds them up.
+		template<typename G>
+		auto degree(G const& g, id_of<G> u, bool forward) -> std::size_t {
+			if (forward) {
+				return g.out_edges(u).size();
+			}
+			auto edges = std::size_t{0};
+			for (auto const& [source, count] : g.in_edges(u)) {
+				edges += count;
+			}
+			return edges;
+		}
+
+		// Calls f(v) once for every distinct neighbour v of u, and stops as soon as f returns
+		// true. Returns whether it stopped.
+		template<typename G, typename F>
+		auto any_neighbour(G const& g, id_of<G> u, bool forward, F f) -> bool {
+			if (forward) {
+				auto const& edges = g.out_edges(u);
+				for (auto i = edges.begin(); i != edges.end(); ++i) {
+					// Edges to the same destination sit next to each other.
+					if ((i == edges.begin() || std::prev(i)->first != i->first) && f(i->first)) {
+						return true;
+					}
+				}
+				return false;
+			}
+			for (auto const& [v, count] : g.in_edges(u)) {
+				if (f(v)) {
+					return true;
+				}
+			}
+			return false;
+		}
+
+		template<typename G, typename F>
+		auto for_each_neighbour(G const& g, id_of<G> u, bool forward, F f) -> void {
+			any_neighbour(g, u, forward, [&f](id_of<G> v) {
+				f(v);
+				return false;
+			});
+		}
+
+		// Direction optimising breadth first search from sources over the nodes keep() accepts,
+		// following edges forwards or backwards. Returns the depth of every node by ID, or
+		// unreached.
+		// While the frontier is small it is expanded top down: each thread takes part of the
+		// frontier and claims unvisited neighbours with a compare and swap into its own next
+		// frontier. Once the frontier's edges outweigh the unexplored ones it switches to bottom
+		// up: each thread takes a range of unvisited nodes and checks them for a neighbour on the
+		// frontier, stopping at the first one. This is the heuristic of Beamer, Asanovic and
+		// Patterson, "Direction-Optimizing Breadth-First Search" (2012).
+		template<typename G, typename Keep>
+		auto level_search(G const& g,
+		                  std::vector<id_of<G>> const& sources,
+		                  bool forward,
+		                  Keep keep,
+		                  unsigned threads) -> std::vector<std::size_t> {
+			using id_type = id_of<G>;
+			constexpr auto alpha = std::size_t{14};
+			constexpr auto beta = std::size_t{24};
+			auto bound = g.id_bound();
+			auto depth = std::vector<std::atomic<std::size_t>>(bound);
+			auto unexplored = std::size_t{0}; // Edges leaving nodes that haven't been reached
+			for (auto i = std::size_t{0}; i < bound; ++i) {
+				depth[i].store(unreached, std::memory_order_relaxed);
+				auto id = static_cast<id_type>(i);
+				if (g.is_node(id) && keep(id)) {
+					unexplored += degree(g, id, forward);
+				}
+			}
+			auto frontier = std::vector<id_type>{};
+			for (auto s : sources) {
+				if (depth[index<G>(s)].exchange(0, std::memory_order_relaxed) == unreached) {
+					frontier.push_back(s);
+				}
+			}
+
+			auto bottom_up = false;
+			for (auto level = std::size_t{0}; !frontier.empty(); ++level) {
+				auto frontier_edges = std::size_t{0};
+				for (auto u : frontier) {
+					frontier_edges += degree(g, u, forward);
+				}
+				unexplored -= std::min(unexplored, frontier_edges);
+				if (!bottom_up && frontier_edges > unexplored / alpha) {
+					bottom_up = true;
+				}
+				else if (bottom_up && frontier.size() < bound / beta) {
+					bottom_up = false;
+				}
+
+				auto workers = worker_count(threads, bottom_up ? bound : frontier.size());
+				auto next = std::vector<std::vector<id_type>>(workers);
+				if (bottom_up) {
+					auto work = [&](std::size_t worker, std::size_t first, std::size_t last) {
+						for (auto i = first; i < last; ++i) {
+							auto v = static_cast<id_type>(i);
+							if (depth[i].load(std::memory_order_relaxed) != unreached || !g.is_node(v)
+							    || !keep(v))
+							{
+								continue;
+							}
+							// A parent on the frontier is a neighbour in the other direction.
+							auto found = any_neighbour(g, v, !forward, [&](id_type u) {
+								return depth[index<G>(u)].load(std::memory_order_relaxed) == level;
+							});
+							if (found) {
+								depth[i].store(level + 1, std::memory_order_relaxed);
+								next[worker].push_back(v);
+							}
+						}
+					};
+					parallel_for(workers, bound, work);
+				}
+				else {
+					auto work = [&](std::size_t worker, std::size_t first, std::size_t last) {
+						for (auto i = first; i < last; ++i) {
+							for_each_neighbour(g, frontier[i], forward, [&](id_type v) {
+								auto& slot = depth[index<G>(v)];
+								auto expected = unreached;
+								auto relaxed = std::memory_order_relaxed;
+								if (keep(v) && slot.compare_exchange_strong(expected, level + 1, relaxed)) {
+									next[worker].push_back(v);
+								}
+							});
+						}
+					};
+					parallel_for(workers, frontier.size(), work);
+				}
+				frontier = concatenate(next);
+			}
+
+			auto result = std::vector<std::size_t>(bound);
+			for (auto i = std::size_t{0}; i < bound; ++i) {
+				result[i] = depth[i].load(std::memory_order_relaxed);
+			}
+			return result;
+		}
+
+		// Turns depths by ID into a map from node to depth.
+		template<typename N, typename G>
+		auto make_depths(G const& g, std::vector<std::size_t> const& depth)
+		   -> std::map<N, std::size_t> {
+			auto result = std::map<N, std::size_t>{};
+			for (auto i = std::size_t{0}; i < depth.size(); ++i) {
+				if (depth[i] != unreached) {
+					result.emplace(g.node(static_cast<id_of<G>>(i)), depth[i]);
+				}
+			}
+			return result;
+		}
+
+		// Groups nodes by their label. Each component is sorted, and the components are sorted
+		// by their smallest node, so the result doesn't depend on how labels were handed out.
+		template<typename N, typename G>
+		auto make_components(G const& g, std::vector<std::size_t> const& label)
+		   -> std::vector<std::vector<N>> {
+			auto groups = std::map<std::size_t, std::vector<N>>{};
+			for (auto i = std::size_t{0}; i < label.size(); ++i) {
+				if (label[i] != unreached) {
+					groups[label[i]].push_back(g.node(static_cast<id_of<G>>(i)));
+				}
+			}
+			auto result = std::vector<std::vector<N>>{};
+			result.reserve(groups.size());
+			for (auto& [l, group] : groups) {
+				std::sort(group.begin(), group.end());
+				result.push_back(std::move(group));
+			}
+			std::sort(result.begin(), result.end(), [](auto const& a, auto const& b) {
+				return a.front() < b.front();
+			});
+			return result;
+		}
+
+		// Scratch space for tarjan(), indexed by ID. Calls on disjoint sets of nodes can share
+		// it, even from different threads.
+		struct tarjan_state {
+			explicit tarjan_state(std::size_t bound)
+			: order(bound, unreached)
+			, low(bound, 0)
+			, on_stack(bound, 0) {}
+
+			std::vector<std::size_t> order;
+			std::vector<std::size_t> low;
+			std::vector<char> on_stack;
+		};
+
+		// Tarjan's algorithm over the nodes keep() accepts, without recursion. Every node of a
+		// component is labelled with the ID of the first node of it that was reached.
+		template<typename G, typename Keep>
+		auto tarjan(G const& g,
+		            std::vector<id_of<G>> const& roots,
+		            Keep keep,
+		            tarjan_state& state,
+		            std::vector<std::size_t>& label) -> void {
+			using id_type = id_of<G>;
+			using edge_iterator = typename G::destination_node::const_iterator;
+			auto& order = state.order;
+			auto& low = state.low;
+			auto& on_stack = state.on_stack;
+			auto stack = std::vector<id_type>{};
+			auto calls = std::vector<std::pair<id_type, edge_iterator>>{};
+			auto counter = std::size_t{0};
+			auto visit = [&](id_type v) {
+				order[index<G>(v)] = low[index<G>(v)] = counter++;
+				on_stack[index<G>(v)] = 1;
+				stack.push_back(v);
+				calls.emplace_back(v, g.out_edges(v).begin());
+			};
+			for (auto root : roots) {
+				if (order[index<G>(root)] != unreached) {
+					continue;
+				}
+				visit(root);
+				while (!calls.empty()) {
+					auto& [u, edge] = calls.back();
+					auto const& edges = g.out_edges(u);
+					if (edge != edges.end()) {
+						auto v = (edge++)->first;
+						if (!keep(v)) {
+							continue;
+						}
+						if (order[index<G>(v)] == unreached) {
+							visit(v);
+						}
+						else if (on_stack[index<G>(v)]) {
+							low[index<G>(u)] = std::min(low[index<G>(u)], order[index<G>(v)]);
+						}
+						continue;
+					}
+					// Every edge of u is done.
+					auto finished = u;
+					calls.pop_back();
+					if (!calls.empty()) {
+						auto parent = index<G>(calls.back().first);
+						low[parent] = std::min(low[parent], low[index<G>(finished)]);
+					}
+					if (low[index<G>(finished)] == order[index<G>(finished)]) {
+						auto w = id_type{};
+						do {
+							w = stack.back();
+							stack.pop_back();
+							on_stack[index<G>(w)] = 0;
+							label[index<G>(w)] = index<G>(finished);
+						} while (w != finished);
+					}
+				}
+			}
+		}
+
+		// Lock free union-find over the nodes keep() accepts, joining the two ends of every edge
+		// between them. Threads take ranges of source nodes, and always hang the larger root
+		// under the smaller one with a compare and swap. Returns the root of every node by ID,
+		// or unreached.
+		template<typename G, typename Keep>
+		auto union_find(G const& g, Keep keep, std::size_t workers) -> std::vector<std::size_t> {
+			using id_type = id_of<G>;
+			auto bound = g.id_bound();
+			auto parent = std::vector<std::atomic<std::size_t>>(bound);
+			for (auto i = std::size_t{0}; i < bound; ++i) {
+				parent[i].store(i, std::memory_order_relaxed);
+			}
+			auto find = [&parent](std::size_t x) {
+				while (true) {
+					auto p = parent[x].load(std::memory_order_relaxed);
+					if (p == x) {
+						return x;
+					}
+					// Path halving: point x at its grandparent, which is still an ancestor.
+					auto gp = parent[p].load(std::memory_order_relaxed);
+					parent[x].compare_exchange_weak(p, gp, std::memory_order_relaxed);
+					x = gp;
+				}
+			};
+			auto kept = [&](std::size_t i) {
+				return g.is_node(static_cast<id_type>(i)) && keep(static_cast<id_type>(i));
+			};
+			parallel_for(workers, bound, [&](std::size_t, std::size_t first, std::size_t last) {
+				for (auto i = first; i < last; ++i) {
+					if (!kept(i)) {
+						continue;
+					}
+					for_each_neighbour(g, static_cast<id_type>(i), true, [&](id_type v) {
+						if (!keep(v)) {
+							return;
+						}
+						auto a = i;
+						auto b = index<G>(v);
+						while (true) {
+							a = find(a);
+							b = find(b);
+							if (a == b) {
+								return;
+							}
+							if (a < b) {
+								std::swap(a, b);
+							}
+							if (parent[a].compare_exchange_strong(a, b, std::memory_order_relaxed)) {
+								return;
+							}
+						}
+					});
+				}
+			});
+			auto root = std::vector<std::size_t>(bound, unreached);
+			parallel_for(workers, bound, [&](std::size_t, std::size_t first, std::size_t last) {
+				for (auto i = first; i < last; ++i) {
+					if (kept(i)) {
+						root[i] = find(i);
+					}
+				}
+			});
+			return root;
+		}
+
+		template<typename G>
+		auto all_nodes(G const& g) -> std::vector<id_of<G>> {
+			auto ids = std::vector<id_of<G>>{};
+			for (auto i = std::size_t{0}; i < g.id_bound(); ++i) {
+				if (g.is_node(static_cast<id_of<G>>(i))) {
+					ids.push_back(static_cast<id_of<G>>(i));
+				}
+			}
+			return ids;
+		}
+
+		// Sorts IDs by the nodes behind them.
+		template<typename G>
+		auto sort_by_node(G const& g, std::vector<id_of<G>>& ids) -> void {
+			std::sort(ids.begin(), ids.end(), [&g](id_of<G> a, id_of<G> b) {
+				return g.node(a) < g.node(b);
+			});
+		}
+
+		// An edge of G by reference: its end points' IDs and where its weight is in the graph.
+		template<typename G>
+		struct edge_ref {
+			id_of<G> from;
+			id_of<G> to;
+			decltype(std::declval<typename G::value_type>().weight) const* weight;
+		};
+
+		// Every edge of g in iteration order.
+		template<typename G>
+		auto edges_in_order(G const& g) -> std::vector<edge_ref<G>> {
+			auto ids = all_nodes(g);
+			sort_by_node(g, ids);
+			auto edges = std::vector<edge_ref<G>>{};
+			for (auto u : ids) {
+				for (auto const& [v, w] : g.out_edges(u)) {
+					edges.push_back(edge_ref<G>{u, v, &w});
+				}
+			}
+			return edges;
+		}
+	} // namespace detail
+
+	/***************************************
+	**                                    **
+	**       Breadth first search         **
+	**                                    **
+	***************************************/
+
+	// Returns the number of edges on the shortest path from src to every node it can reach.
+	template<typename N, typename E, typename Allocator, typename Lookup>
+	auto bfs(graph<N, E, Allocator, Lookup> const& g, N const& src) -> std::map<N, std::size_t> {
+		using G = graph<N, E, Allocator, Lookup>;
+		if (!g.is_node(src)) {
+			throw std::runtime_error("Cannot call a gdwg breadth first search if src doesn't exist "
+			                         "in the graph");
+		}
+		auto depth = std::vector<std::size_t>(g.id_bound(), detail::unreached);
+		auto queue = std::vector<typename G::id_type>{g.node_id(src)};
+		depth[detail::index<G>(queue.front())] = 0;
+		for (auto head = std::size_t{0}; head < queue.size(); ++head) {
+			auto u = queue[head];
+			for (auto const& [v, w] : g.out_edges(u)) {
+				if (depth[detail::index<G>(v)] == detail::unreached) {
+					depth[detail::index<G>(v)] = depth[detail::index<G>(u)] + 1;
+					queue.push_back(v);
+				}
+			}
+		}
+		return detail::make_depths<N>(g, depth);
+	}
+
+	// The same search, direction optimising and spread over threads.
+	template<typename N, typename E, typename Allocator, typename Lookup>
+	auto parallel_bfs(graph<N, E, Allocator, Lookup> const& g, N const& src, unsigned threads = 0)
+	   -> std::map<N, std::size_t> {
+		if (!g.is_node(src)) {
+			throw std::runtime_error("Cannot call a gdwg breadth first search if src doesn't exist "
+			                         "in the graph");
+		}
+		auto depth = detail::level_search(
+		   g,
+		   {g.node_id(src)},
+		   true,
+		   [](auto) { return true; },
+		   detail::thread_count(threads));
+		return detail::make_depths<N>(g, depth);
+	}
+
+	/***************************************
+	**                                    **
+	**      Connected components          **
+	**                                    **
+	***************************************/
+
+	// Groups the nodes that are connected when edge directions are ignored. Each component is
+	// sorted, and the components are sorted by their smallest node.
+	template<typename N, typename E, typename Allocator, typename Lookup>
+	auto weakly_connected_components(graph<N, E, Allocator, Lookup> const& g)
+	   -> std::vector<std::vector<N>> {
+		using G = graph<N, E, Allocator, Lookup>;
+		using id_type = typename G::id_type;
+		auto label = std::vector<std::size_t>(g.id_bound(), detail::unreached);
+		auto queue = std::vector<id_type>{};
+		for (auto root : detail::all_nodes(g)) {
+			if (label[detail::index<G>(root)] != detail::unreached) {
+				continue;
+			}
+			label[detail::index<G>(root)] = detail::index<G>(root);
+			queue.assign(1, root);
+			for (auto head = std::size_t{0}; head < queue.size(); ++head) {
+				auto reach = [&](id_type v) {
+					if (label[detail::index<G>(v)] == detail::unreached) {
+						label[detail::index<G>(v)] = detail::index<G>(root);
+						queue.push_back(v);
+					}
+				};
+				detail::for_each_neighbour(g, queue[head], true, reach);
+				detail::for_each_neighbour(g, queue[head], false, reach);
+			}
+		}
+		return detail::make_components<N>(g, label);
+	}
+
+	// The same components, found by a lock free union-find over the edges.
+	template<typename N, typename E, typename Allocator, typename Lookup>
+	auto parallel_weakly_connected_components(graph<N, E, Allocator, Lookup> const& g,
+	                                          unsigned threads = 0) -> std::vector<std::vector<N>> {
+		auto workers = detail::worker_count(detail::thread_count(threads), g.id_bound());
+		auto root = detail::union_find(
+		   g,
+		   [](auto) { return true; },
+		   workers);
+		return detail::make_components<N>(g, root);
+	}
+
+	// Groups the nodes that can all reach each other. Each component is sorted, and the
+	// components are sorted by their smallest node.
+	template<typename N, typename E, typename Allocator, typename Lookup>
+	auto strongly_connected_components(graph<N, E, Allocator, Lookup> const& g)
+	   -> std::vector<std::vector<N>> {
+		auto label = std::vector<std::size_t>(g.id_bound(), detail::unreached);
+		auto state = detail::tarjan_state(g.id_bound());
+		detail::tarjan(
+		   g,
+		   detail::all_nodes(g),
+		   [](auto) { return true; },
+		   state,
+		   label);
+		return detail::make_components<N>(g, label);
+	}
+
+	// The same components, found the way Hong, Rodia and Olukotun describe in "On Fast Parallel
+	// Detection of Strongly Connected Components (SCC) in Small-World Graphs" (2013):
+	//  1. Nodes with no edges in or no edges out are trimmed off as components of their own.
+	//  2. The forward and backward reach of a well connected pivot are found with the parallel
+	//     search. Where they meet is the pivot's component, which in most real graphs is the
+	//     one giant component.
+	//  3. What is left splits into weakly connected pieces, which can't share a strongly
+	//     connected component. The threads take the pieces, largest first, and run Tarjan's
+	//     algorithm on each.
+	template<typename N, typename E, typename Allocator, typename Lookup>
+	auto parallel_strongly_connected_components(graph<N, E, Allocator, Lookup> const& g,
+	                                            unsigned threads = 0)
+	   -> std::vector<std::vector<N>> {
+		using G = graph<N, E, Allocator, Lookup>;
+		using id_type = typename G::id_type;
+		threads = detail::thread_count(threads);
+		auto bound = g.id_bound();
+		auto label = std::vector<std::size_t>(bound, detail::unreached);
+		auto unlabelled = [&label](id_type v) {
+			return label[detail::index<G>(v)] == detail::unreached;
+		};
+
+		auto ids = detail::all_nodes(g);
+		auto workers = detail::worker_count(threads, ids.size());
+		auto trim = [&](std::size_t, std::size_t first, std::size_t last) {
+			for (auto i = first; i < last; ++i) {
+				auto v = ids[i];
+				auto other = [v](id_type u) { return u != v; };
+				if (!detail::any_neighbour(g, v, true, other)
+				    || !detail::any_neighbour(g, v, false, other)) {
+					label[detail::index<G>(v)] = detail::index<G>(v);
+				}
+			}
+		};
+		detail::parallel_for(workers, ids.size(), trim);
+
+		auto pivot = std::optional<id_type>{};
+		auto best = std::size_t{0};
+		for (auto v : ids) {
+			auto weight = g.out_edges(v).size() * g.in_edges(v).size();
+			if (unlabelled(v) && (!pivot || weight > best)) {
+				pivot = v;
+				best = weight;
+			}
+		}
+		if (pivot) {
+			auto forward = detail::level_search(g, {*pivot}, true, unlabelled, threads);
+			auto backward = detail::level_search(g, {*pivot}, false, unlabelled, threads);
+			for (auto v : ids) {
+				auto i = detail::index<G>(v);
+				if (forward[i] != detail::unreached && backward[i] != detail::unreached) {
+					label[i] = detail::index<G>(*pivot);
+				}
+			}
+		}
+
+		auto root = detail::union_find(g, unlabelled, detail::worker_count(threads, bound));
+		auto pieces = std::map<std::size_t, std::vector<id_type>>{};
+		for (auto v : ids) {
+			if (root[detail::index<G>(v)] != detail::unreached) {
+				pieces[root[detail::index<G>(v)]].push_back(v);
+			}
+		}
+		auto work = std::vector<std::vector<id_type>>{};
+		for (auto& [r, members] : pieces) {
+			work.push_back(std::move(members));
+		}
+		std::sort(work.begin(), work.end(), [](auto const& a, auto const& b) {
+			return a.size() > b.size();
+		});
+		auto state = detail::tarjan_state(bound);
+		auto next = std::atomic<std::size_t>{0};
+		auto run = [&](std::size_t, std::size_t, std::size_t) {
+			for (auto i = next++; i < work.size(); i = next++) {
+				auto piece = root[detail::index<G>(work[i].front())];
+				auto keep = [&root, piece](id_type v) { return root[detail::index<G>(v)] == piece; };
+				detail::tarjan(g, work[i], keep, state, label);
+			}
+		};
+		detail::parallel_for(std::min<std::size_t>(threads, work.size()), work.size(), run);
+		return detail::make_components<N>(g, label);
+	}
+
+	/***************************************
+	**                                    **
+	**         Topological sort           **
+	**                                    **
+	***************************************/
+
+	// Orders the nodes so every edge goes from an earlier node to a later one. Nodes come out
+	// level by level, where a node's level is the length of the longest path into it, and each
+	// level is in increasing order. Throws if the graph has a cycle.
+	template<typename N, typename E, typename Allocator, typename Lookup>
+	auto topological_sort(graph<N, E, Allocator, Lookup> const& g) -> std::vector<N> {
+		using G = graph<N, E, Allocator, Lookup>;
+		using id_type = typename G::id_type;
+		auto ids = detail::all_nodes(g);
+		auto in_degree = std::vector<std::size_t>(g.id_bound(), 0);
+		auto level = std::vector<id_type>{};
+		for (auto v : ids) {
+			in_degree[detail::index<G>(v)] = g.in_edges(v).size();
+			if (in_degree[detail::index<G>(v)] == 0) {
+				level.push_back(v);
+			}
+		}
+		auto result = std::vector<N>{};
+		result.reserve(ids.size());
+		while (!level.empty()) {
+			detail::sort_by_node(g, level);
+			auto next = std::vector<id_type>{};
+			for (auto u : level) {
+				result.push_back(g.node(u));
+				detail::for_each_neighbour(g, u, true, [&](id_type v) {
+					if (--in_degree[detail::index<G>(v)] == 0) {
+						next.push_back(v);
+					}
+				});
+			}
+			level = std::move(next);
+		}
+		if (result.size() != ids.size()) {
+			throw std::runtime_error("Cannot call a gdwg topological sort on a graph with a cycle");
+		}
+		return result;
+	}
+
+	// The same order, with each level's edges spread over threads.
+	template<typename N, typename E, typename Allocator, typename Lookup>
+	auto parallel_topological_sort(graph<N, E, Allocator, Lookup> const& g, unsigned threads = 0)
+	   -> std::vector<N> {
+		using G = graph<N, E, Allocator, Lookup>;
+		using id_type = typename G::id_type;
+		threads = detail::thread_count(threads);
+		auto ids = detail::all_nodes(g);
+		auto in_degree = std::vector<std::atomic<std::size_t>>(g.id_bound());
+		auto level = std::vector<id_type>{};
+		for (auto v : ids) {
+			in_degree[detail::index<G>(v)].store(g.in_edges(v).size(), std::memory_order_relaxed);
+			if (g.in_edges(v).empty()) {
+				level.push_back(v);
+			}
+		}
+		auto result = std::vector<N>{};
+		result.reserve(ids.size());
+		while (!level.empty()) {
+			detail::sort_by_node(g, level);
+			for (auto u : level) {
+				result.push_back(g.node(u));
+			}
+			auto next = std::vector<std::vector<id_type>>(detail::worker_count(threads, level.size()));
+			auto work = [&](std::size_t worker, std::size_t first, std::size_t last) {
+				for (auto i = first; i < last; ++i) {
+					detail::for_each_neighbour(g, level[i], true, [&](id_type v) {
+						auto& count = in_degree[detail::index<G>(v)];
+						if (count.fetch_sub(1, std::memory_order_relaxed) == 1) {
+							next[worker].push_back(v);
+						}
+					});
+				}
+			};
+			detail::parallel_for(next.size(), level.size(), work);
+			level = detail::concatenate(next);
+		}
+		if (result.size() != ids.size()) {
+			throw std::runtime_error("Cannot call a gdwg topological sort on a graph with a cycle");
+		}
+		return result;
+	}
+} // namespace gdwg
+
+#endif // GDWG_TRAVERSAL_HPP
@@ -0,0 +1,351 @@
+#ifndef GDWG_WEIGHT_SCAN_HPP
+#define GDWG_WEIGHT_SCAN_HPP
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) \
+   && !defined(GDWG_WEIGHT_SCAN_NO_SIMD)
+#include <immintrin.h>
+#define GDWG_WEIGHT_SCAN_HAS_AVX2 1
+#endif
+
+#include "gdwg/graph.hpp"
+
+// Scans over the weights of the edges leaving one node. A node's edges sit in one contiguous
+// block, so each scan is a single pass over memory. For 32 and 64 bit signed integer and
+// floating point weights on x86, the pass uses AVX2 when the CPU has it. The choice is made at
+// run time, and every other case runs a plain loop that gives the same answers. Define
+// GDWG_WEIGHT_SCAN_NO_SIMD to always use the plain loop.
+namespace gdwg {
+	template<typename E>
+	struct weight_summary {
+		std::size_t count = 0; // Number of edges
+		E min{}; // Smallest weight, or E{} when there are no edges
+		E max{}; // Largest weight, or E{} when there are no edges
+		E sum{}; // Sum of the weights
+	};
+
+	namespace detail {
+		// Calls out(i) for every edge i of the count at edges with a weight in [lo, hi].
+		template<typename E, typename Edge, typename Out>
+		auto
+		scan_weight_range(Edge const* edges, std::size_t count, E const& lo, E const& hi, Out out)
+		   -> void {
+			for (auto i = std::size_t{0}; i < count; ++i) {
+				if (!(edges[i].second < lo) && !(hi < edges[i].second)) {
+					out(i);
+				}
+			}
+		}
+
+		// Adds two weights. Signed integers are added as their unsigned counterparts, so a sum
+		// that overflows wraps the way the vector adds do instead of being undefined.
+		template<typename E>
+		auto add_weights(E const& a, E const& b) -> E {
+			if constexpr (std::is_integral_v<E> && std::is_signed_v<E>) {
+				using U = std::make_unsigned_t<E>;
+				return static_cast<E>(static_cast<U>(static_cast<U>(a) + static_cast<U>(b)));
+			}
+			else {
+				return static_cast<E>(a + b);
+			}
+		}
+
+		// Folds the weights of the count edges at edges into summary, one at a time.
+		template<typename E, typename Edge>
+		auto fold_weights(weight_summary<E>& summary, Edge const* edges, std::size_t count) -> void {
+			for (auto i = std::size_t{0}; i < count; ++i) {
+				auto const& w = edges[i].second;
+				if (summary.count == 0) {
+					summary.min = w;
+					summary.max = w;
+				}
+				summary.min = w < summary.min ? w : summary.min;
+				summary.max = summary.max < w ? w : summary.max;
+				summary.sum = add_weights(summary.sum, w);
+				++summary.count;
+			}
+		}
+
+		template<typename E>
+		inline constexpr bool is_int32_weight = std::is_integral_v<E> && std::is_signed_v<E>
+		                                        && sizeof(E) == 4;
+
+		template<typename E>
+		inline constexpr bool is_int64_weight = std::is_integral_v<E> && std::is_signed_v<E>
+		                                        && sizeof(E) == 8;
+
+		// True when there is a vector kernel for weights of type E.
+		template<typename E>
+		inline constexpr bool has_weight_kernel = is_int32_weight<E> || is_int64_weight<E>
+		                                          || std::is_same_v<E, float>
+		                                          || std::is_same_v<E, double>;
+
+#ifdef GDWG_WEIGHT_SCAN_HAS_AVX2
+		inline auto cpu_has_avx2() noexcept -> bool {
+			static auto const avx2 = __builtin_cpu_supports("avx2") != 0;
+			return avx2;
+		}
+
+		// Loads the weights of the 8 edges at edges, in order. An edge with a 4 byte weight is
+		// the 4 byte ID followed by the weight.
+		[[gnu::target("avx2")]] inline auto load_weights_32(void const* edges) noexcept -> __m256 {
+			auto const* p = static_cast<float const*>(edges);
+			auto mixed = _mm256_shuffle_ps(_mm256_loadu_ps(p), _mm256_loadu_ps(p + 8), 0xdd);
+			return _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(mixed), 0xd8));
+		}
+
+		// Loads the weights of the 4 edges at edges, in order. An edge with an 8 byte weight is
+		// the 4 byte ID, 4 bytes of padding and the weight.
+		[[gnu::target("avx2")]] inline auto load_weights_64(void const* edges) noexcept -> __m256d {
+			auto const* p = static_cast<double const*>(edges);
+			auto mixed = _mm256_unpackhi_pd(_mm256_loadu_pd(p), _mm256_loadu_pd(p + 4));
+			return _mm256_permute4x64_pd(mixed, 0xd8);
+		}
+
+		// The vector operations for one kind of weight. min(w, acc) is w < acc ? w : acc and
+		// max(w, acc) is acc < w ? w : acc, lane by lane, the same as the plain loop.
+		template<typename E>
+		struct avx2_weights;
+
+		template<typename E>
+		requires is_int32_weight<E>
+		struct avx2_weights<E> {
+			using vector = __m256i;
+			static constexpr std::size_t lanes = 8;
+
+			[[gnu::target("avx2")]] static auto load(void const* edges) noexcept -> vector {
+				return _mm256_castps_si256(load_weights_32(edges));
+			}
+			[[gnu::target("avx2")]] static auto splat(E value) noexcept -> vector {
+				return _mm256_set1_epi32(static_cast<std::int32_t>(value));
+			}
+			[[gnu::target("avx2")]] static auto min(vector w, vector acc) noexcept -> vector {
+				return _mm256_min_epi32(w, acc);
+			}
+			[[gnu::target("avx2")]] static auto max(vector w, vector acc) noexcept -> vector {
+				return _mm256_max_epi32(w, acc);
+			}
+			[[gnu::target("avx2")]] static auto add(vector a, vector b) noexcept -> vector {
+				return _mm256_add_epi32(a, b);
+			}
+			// Bit i is set when lane i is in [lo, hi].
+			[[gnu::target("avx2")]] static auto in_range(vector w, vector lo, vector hi) noexcept
+			   -> unsigned {
+				auto outside = _mm256_or_si256(_mm256_cmpgt_epi32(lo, w), _mm256_cmpgt_epi32(w, hi));
+				return ~static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(outside))) & 0xffu;
+			}
+			[[gnu::target("avx2")]] static auto store(E* out, vector v) noexcept -> void {
+				_mm256_storeu_si256(static_cast<__m256i*>(static_cast<void*>(out)), v);
+			}
+		};
+
+		template<typename E>
+		requires is_int64_weight<E>
+		struct avx2_weights<E> {
+			using vector = __m256i;
+			static constexpr std::size_t lanes = 4;
+
+			[[gnu::target("avx2")]] static auto load(void const* edges) noexcept -> vector {
+				return _mm256_castpd_si256(load_weights_64(edges));
+			}
+			[[gnu::target("avx2")]] static auto splat(E value) noexcept -> vector {
+				return _mm256_set1_epi64x(static_cast<long long>(value));
+			}
+			[[gnu::target("avx2")]] static auto min(vector w, vector acc) noexcept -> vector {
+				return _mm256_blendv_epi8(acc, w, _mm256_cmpgt_epi64(acc, w));
+			}
+			[[gnu::target("avx2")]] static auto max(vector w, vector acc) noexcept -> vector {
+				return _mm256_blendv_epi8(acc, w, _mm256_cmpgt_epi64(w, acc));
+			}
+			[[gnu::target("avx2")]] static auto add(vector a, vector b) noexcept -> vector {
+				return _mm256_add_epi64(a, b);
+			}
+			[[gnu::target("avx2")]] static auto in_range(vector w, vector lo, vector hi) noexcept
+			   -> unsigned {
+				auto outside = _mm256_or_si256(_mm256_cmpgt_epi64(lo, w), _mm256_cmpgt_epi64(w, hi));
+				return ~static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(outside))) & 0xfu;
+			}
+			[[gnu::target("avx2")]] static auto store(E* out, vector v) noexcept -> void {
+				_mm256_storeu_si256(static_cast<__m256i*>(static_cast<void*>(out)), v);
+			}
+		};
+
+		template<>
+		struct avx2_weights<float> {
+			using vector = __m256;
+			static constexpr std::size_t lanes = 8;
+
+			[[gnu::target("avx2")]] static auto load(void const* edges) noexcept -> vector {
+				return load_weights_32(edges);
+			}
+			[[gnu::target("avx2")]] static auto splat(float value) noexcept -> vector {
+				return _mm256_set1_ps(value);
+			}
+			[[gnu::target("avx2")]] static auto min(vector w, vector acc) noexcept -> vector {
+				return _mm256_min_ps(w, acc);
+			}
+			[[gnu::target("avx2")]] static auto max(vector w, vector acc) noexcept -> vector {
+				return _mm256_max_ps(w, acc);
+			}
+			[[gnu::target("avx2")]] static auto add(vector a, vector b) noexcept -> vector {
+				return _mm256_add_ps(a, b);
+			}
+			// Like the plain loop, a NaN weight is never below lo or above hi.
+			[[gnu::target("avx2")]] static auto in_range(vector w, vector lo, vector hi) noexcept
+			   -> unsigned {
+				auto inside =
+				   _mm256_and_ps(_mm256_cmp_ps(w, lo, _CMP_NLT_UQ), _mm256_cmp_ps(w, hi, _CMP_NGT_UQ));
+				return static_cast<unsigned>(_mm256_movemask_ps(inside));
+			}
+			[[gnu::target("avx2")]] static auto store(float* out, vector v) noexcept -> void {
+				_mm256_storeu_ps(out, v);
+			}
+		};
+
+		template<>
+		struct avx2_weights<double> {
+			using vector = __m256d;
+			static constexpr std::size_t lanes = 4;
+
+			[[gnu::target("avx2")]] static auto load(void const* edges) noexcept -> vector {
+				return load_weights_64(edges);
+			}
+			[[gnu::target("avx2")]] static auto splat(double value) noexcept -> vector {
+				return _mm256_set1_pd(value);
+			}
+			[[gnu::target("avx2")]] static auto min(vector w, vector acc) noexcept -> vector {
+				return _mm256_min_pd(w, acc);
+			}
+			[[gnu::target("avx2")]] static auto max(vector w, vector acc) noexcept -> vector {
+				return _mm256_max_pd(w, acc);
+			}
+			[[gnu::target("avx2")]] static auto add(vector a, vector b) noexcept -> vector {
+				return _mm256_add_pd(a, b);
+			}
+			[[gnu::target("avx2")]] static auto in_range(vector w, vector lo, vector hi) noexcept
+			   -> unsigned {
+				auto inside =
+				   _mm256_and_pd(_mm256_cmp_pd(w, lo, _CMP_NLT_UQ), _mm256_cmp_pd(w, hi, _CMP_NGT_UQ));
+				return static_cast<unsigned>(_mm256_movemask_pd(inside));
+			}
+			[[gnu::target("avx2")]] static auto store(double* out, vector v) noexcept -> void {
+				_mm256_storeu_pd(out, v);
+			}
+		};
+
+		template<typename E, typename Edge, typename Out>
+		[[gnu::target("avx2")]] auto
+		scan_weight_range_avx2(Edge const* edges, std::size_t count, E lo, E hi, Out out) -> void {
+			using ops = avx2_weights<E>;
+			static_assert(sizeof(Edge) == 2 * sizeof(E));
+			auto const low = ops::splat(lo);
+			auto const high = ops::splat(hi);
+			auto i = std::size_t{0};
+			for (; i + ops::lanes <= count; i += ops::lanes) {
+				auto hits = ops::in_range(ops::load(edges + i), low, high);
+				for (; hits != 0; hits &= hits - 1) {
+					out(i + static_cast<std::size_t>(std::countr_zero(hits)));
+				}
+			}
+			scan_weight_range(edges + i, count - i, lo, hi, [&](std::size_t j) { out(i + j); });
+		}
+
+		// Folds whole vectors of weights into summary, then the rest one at a time. Each lane
+		// keeps its own sum, so floating point sums can round differently to a plain loop.
+		template<typename E, typename Edge>
+		[[gnu::target("avx2")]] auto
+		fold_weights_avx2(weight_summary<E>& summary, Edge const* edges, std::size_t count) -> void {
+			using ops = avx2_weights<E>;
+			static_assert(sizeof(Edge) == 2 * sizeof(E));
+			if (count < ops::lanes) {
+				fold_weights(summary, edges, count);
+				return;
+			}
+			auto low = ops::load(edges);
+			auto high = low;
+			auto sum = ops::splat(E{});
+			auto i = std::size_t{0};
+			for (; i + ops::lanes <= count; i += ops::lanes) {
+				auto w = ops::load(edges + i);
+				low = ops::min(w, low);
+				high = ops::max(w, high);
+				sum = ops::add(sum, w);
+			}
+			auto lows = std::array<E, ops::lanes>{};
+			auto highs = std::array<E, ops::lanes>{};
+			auto sums = std::array<E, ops::lanes>{};
+			ops::store(lows.data(), low);
+			ops::store(highs.data(), high);
+			ops::store(sums.data(), sum);
+			summary = weight_summary<E>{i, lows[0], highs[0], sums[0]};
+			for (auto k = std::size_t{1}; k < ops::lanes; ++k) {
+				summary.min = lows[k] < summary.min ? lows[k] : summary.min;
+				summary.max = summary.max < highs[k] ? highs[k] : summary.max;
+				summary.sum = add_weights(summary.sum, sums[k]);
+			}
+			fold_weights(summary, edges + i, count - i);
+		}
+#endif
+	} // namespace detail
+
+	// This function returns the edges leaving src with a weight in [lo, hi], in the order the
+	// iterator visits them.
+	template<typename N, typename E, typename Allocator, typename Lookup>
+	auto edges_in_weight_range(graph<N, E, Allocator, Lookup> const& g,
+	                           N const& src,
+	                           E const& lo,
+	                           E const& hi)
+	   -> std::vector<typename graph<N, E, Allocator, Lookup>::value_type> {
+		if (!g.is_node(src)) {
+			throw std::runtime_error("Cannot call gdwg::edges_in_weight_range if src doesn't exist in "
+			                         "the graph");
+		}
+		auto const& edges = g.out_edges(g.node_id(src));
+		auto v = std::vector<typename graph<N, E, Allocator, Lookup>::value_type>{};
+		auto out = [&](std::size_t i) {
+			v.push_back({src, g.node(edges[i].first), edges[i].second});
+		};
+#ifdef GDWG_WEIGHT_SCAN_HAS_AVX2
+		if constexpr (detail::has_weight_kernel<E>) {
+			if (detail::cpu_has_avx2()) {
+				detail::scan_weight_range_avx2(edges.data(), edges.size(), lo, hi, out);
+				return v;
+			}
+		}
+#endif
+		detail::scan_weight_range(edges.data(), edges.size(), lo, hi, out);
+		return v;
+	}
+
+	// This function returns the number, smallest, largest and sum of the weights of the edges
+	// leaving src.
+	template<typename N, typename E, typename Allocator, typename Lookup>
+	requires std::is_arithmetic_v<E>
+	auto out_weight_summary(graph<N, E, Allocator, Lookup> const& g, N const& src)
+	   -> weight_summary<E> {
+		if (!g.is_node(src)) {
+			throw std::runtime_error("Cannot call gdwg::out_weight_summary if src doesn't exist in "
+			                         "the graph");
+		}
+		auto const& edges = g.out_edges(g.node_id(src));
+		auto summary = weight_summary<E>{};
+#ifdef GDWG_WEIGHT_SCAN_HAS_AVX2
+		if constexpr (detail::has_weight_kernel<E>) {
+			if (detail::cpu_has_avx2()) {
+				detail::fold_weights_avx2(summary, edges.data(), edges.size());
+				return summary;
+			}
+		}
+#endif
+		detail::fold_weights(summary, edges.data(), edges.size());
+		return summary;
+	}
+} // namespace gdwg
+
+#endif // GDWG_WEIGHT_SCAN_HPP
@@ -0,0 +1,82 @@
+#include "gdwg/graph.hpp"
+
+#include <catch2/catch.hpp>
+#include <iostream>
+#include <memory_resource>
+#include <string>
+
+// This is the ALLOCATOR TESTING file.
+
+namespace {
+	// A memory resource that counts what passes through it on the way to its upstream.
+	class counting_resource : public std::pmr::memory_resource {
+	public:
+		std::size_t allocations = 0;
+		std::size_t live = 0;
+
+	private:
+		auto do_allocate(std::size_t bytes, std::size_t align) -> void* override {
+			++allocations;
+			++live;
+			return std::pmr::new_delete_resource()->allocate(bytes, align);
+		}
+		auto do_deallocate(void* p, std::size_t bytes, std::size_t align) -> void override {
+			--live;
+			std::pmr::new_delete_resource()->deallocate(p, bytes, align);
+		}
+		auto do_is_equal(std::pmr::memory_resource const& other) const noexcept -> bool override {
+			return this == &other;
+		}
+	};
+} // namespace
+
+TEST_CASE("a pmr graph allocates its nodes and edges from the resource") {
+	auto resource = counting_resource{};
+	{
+		auto g = gdwg::pmr::graph<int, int>({1, 2, 3}, &resource);
+		auto after_nodes = resource.allocations;
+		CHECK(after_nodes > 0);
+		CHECK(g.insert_edge(1, 2, 5));
+		CHECK(g.insert_edge(2, 3, 6));
+		CHECK(resource.allocations > after_nodes);
+		CHECK(g.get_allocator().resource() == &resource);
+		CHECK(g.is_connected(1, 2));
+		// Erasing a node hands its memory back to the resource.
+		auto before_erase = resource.live;
+		CHECK(g.erase_node(2));
+		CHECK(resource.live < before_erase);
+	}
+	// Everything is given back when the graph goes away.
+	CHECK(resource.live == 0);
+}
+
+TEST_CASE("a pmr graph can live inside a monotonic arena") {
+	auto arena = std::pmr::monotonic_buffer_resource{};
+	auto g = gdwg::pmr::graph<std::string, int>({"A", "B", "C"}, &arena);
+	CHECK(g.insert_edge("A", "B", 1));
+	CHECK(g.insert_edge("B", "C", 2));
+	CHECK(g.connections("A") == std::vector<std::string>{"B"});
+	g.clear();
+	CHECK(g.empty());
+	CHECK(g.insert_node("D"));
+}
+
+TEST_CASE("copying and moving pmr graphs between resources") {
+	auto first = counting_resource{};
+	auto second = counting_resource{};
+	auto g = gdwg::pmr::graph<std::string, int>({"A", "B"}, &first);
+	CHECK(g.insert_edge("A", "B", 1));
+	// A copy with an explicit allocator lives in the new resource.
+	auto h = gdwg::pmr::graph<std::string, int>(g, &second);
+	CHECK(h.get_allocator().resource() == &second);
+	CHECK(h.is_connected("A", "B"));
+	// Move-assigning across resources copies the nodes into our own resource.
+	auto k = gdwg::pmr::graph<std::string, int>(&second);
+	auto used = first.allocations;
+	k = std::move(g);
+	CHECK(first.allocations == used);
+	CHECK(k.get_allocator().resource() == &second);
+	CHECK(k.is_connected("A", "B"));
+	CHECK(k.insert_edge("B", "A", 2));
+	CHECK(k.in_connections("A") == std::vector<std::string>{"B"});
+}
@@ -0,0 +1,98 @@
+#include "gdwg/concurrent_graph.hpp"
+#include "gdwg/graph.hpp"
+
+#include <catch2/catch.hpp>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+// This is the BATCH QUERY TESTING file.
+
+namespace {
+	auto random_graph(int n, int m, unsigned seed) -> gdwg::graph<int, int> {
+		auto g = gdwg::graph<int, int>{};
+		for (auto i = 0; i < n; ++i) {
+			g.insert_node(i);
+		}
+		auto rng = std::mt19937{seed};
+		auto pick = std::uniform_int_distribution<int>{0, n - 1};
+		for (auto i = 0; i < m; ++i) {
+			g.insert_edge(pick(rng), pick(rng), i % 4);
+		}
+		return g;
+	}
+} // namespace
+
+TEST_CASE("batch queries answer in the order they were asked") {
+	auto g = gdwg::graph<std::string, int>{"A", "B", "C", "D"};
+	CHECK(g.insert_edge("A", "B", 1));
+	CHECK(g.insert_edge("A", "B", 2));
+	CHECK(g.insert_edge("C", "A", 3));
+	CHECK(g.insert_edge("A", "D", 4));
+
+	auto const pairs = std::vector<std::pair<std::string, std::string>>{
+	   {"C", "A"}, {"A", "D"}, {"A", "C"}, {"A", "B"}, {"D", "A"}, {"A", "D"}};
+	CHECK(g.is_connected_batch(pairs) == std::vector<bool>{true, true, false, true, false, true});
+
+	using edge = gdwg::graph<std::string, int>::value_type;
+	auto const edges =
+	   std::vector<edge>{{"A", "B", 2}, {"A", "B", 3}, {"Z", "A", 1}, {"C", "A", 3}, {"A", "Z", 1}};
+	auto found = g.find_batch(edges);
+	REQUIRE(found.size() == 5);
+	CHECK(found[0] == g.find("A", "B", 2));
+	CHECK(found[1] == g.end());
+	CHECK(found[2] == g.end());
+	CHECK(found[3] == g.find("C", "A", 3));
+	CHECK(found[4] == g.end());
+	CHECK((*found[3]).weight == 3);
+
+	auto const sources = std::vector<std::string>{"C", "A", "B", "A"};
+	auto connected = g.connections_batch(sources);
+	CHECK(connected[0] == std::vector<std::string>{"A"});
+	CHECK(connected[1] == std::vector<std::string>{"B", "D"});
+	CHECK(connected[2].empty());
+	CHECK(connected[3] == connected[1]);
+
+	CHECK(g.is_connected_batch(std::span<std::pair<std::string, std::string> const>{}).empty());
+}
+
+TEST_CASE("batch queries throw like the single queries") {
+	auto g = gdwg::graph<int, int>{1, 2};
+	CHECK(g.insert_edge(1, 2, 1));
+	auto const missing_src = std::vector<std::pair<int, int>>{{1, 2}, {3, 1}};
+	CHECK_THROWS_AS(g.is_connected_batch(missing_src), std::runtime_error);
+	auto const missing_dst = std::vector<std::pair<int, int>>{{1, 2}, {1, 3}};
+	CHECK_THROWS_AS(g.is_connected_batch(missing_dst, 4), std::runtime_error);
+	auto const sources = std::vector<int>{1, 5};
+	CHECK_THROWS_AS(g.connections_batch(sources), std::runtime_error);
+}
+
+TEST_CASE("large batches spread over threads agree with the single queries") {
+	auto g = random_graph(2000, 20000, 11);
+	auto rng = std::mt19937{12};
+	auto pick = std::uniform_int_distribution<int>{0, 1999};
+	auto pairs = std::vector<std::pair<int, int>>{};
+	auto edges = std::vector<gdwg::graph<int, int>::value_type>{};
+	auto sources = std::vector<int>{};
+	for (auto i = 0; i < 50000; ++i) {
+		auto src = pick(rng);
+		auto dst = pick(rng);
+		pairs.emplace_back(src, dst);
+		edges.push_back({src, dst, i % 4});
+		sources.push_back(src);
+	}
+	for (auto threads : {1U, 4U, 0U}) {
+		auto connected = g.is_connected_batch(pairs, threads);
+		auto found = g.find_batch(edges, threads);
+		auto neighbours = g.connections_batch(sources, threads);
+		for (auto i = std::size_t{0}; i < pairs.size(); ++i) {
+			CHECK(connected[i] == g.is_connected(pairs[i].first, pairs[i].second));
+			CHECK(found[i] == g.find(edges[i].from, edges[i].to, edges[i].weight));
+			CHECK(neighbours[i] == g.connections(sources[i]));
+		}
+	}
+
+	auto shared = gdwg::concurrent_graph<int, int>(g);
+	CHECK(shared.is_connected_batch(pairs, 2) == g.is_connected_batch(pairs));
+}
@@ -0,0 +1,155 @@
+#include "gdwg/binary.hpp"
+
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+
+// This is the BINARY SAVE AND LOAD TESTING file.
+
+namespace {
+	// A type that is not trivially copyable and has its own codec.
+	struct label {
+		std::string text;
+		friend auto operator==(label const&, label const&) -> bool = default;
+		friend auto operator<(label const& a, label const& b) -> bool {
+			return a.text < b.text;
+		}
+		friend auto operator<<(std::ostream& os, label const& l) -> std::ostream& {
+			return os << l.text;
+		}
+	};
+
+	struct label_codec {
+		static auto encode(label const& value, std::vector<std::byte>& out) -> void {
+			gdwg::codec<std::string>::encode(value.text, out);
+		}
+		static auto decode(std::byte const* data, std::size_t size) -> label {
+			return label{gdwg::codec<std::string>::decode(data, size)};
+		}
+	};
+
+	auto text(auto const& g) -> std::string {
+		auto os = std::ostringstream{};
+		os << g;
+		return os.str();
+	}
+} // namespace
+
+TEST_CASE("raw nodes and weights round trip through a stream") {
+	auto g = gdwg::graph<int, double>{1, 2, 3, 4};
+	CHECK(g.insert_edge(1, 2, 0.5));
+	CHECK(g.insert_edge(1, 2, 1.5));
+	CHECK(g.insert_edge(3, 1, 2.0));
+	CHECK(g.insert_edge(4, 4, 3.0));
+	auto buffer = std::stringstream{};
+	gdwg::save(g, buffer);
+	auto h = gdwg::load<int, double>(buffer);
+	CHECK(text(h) == text(g));
+	CHECK(h.weights(1, 2) == std::vector<double>{0.5, 1.5});
+}
+
+TEST_CASE("encoded nodes go through their codec") {
+	auto g = gdwg::graph<std::string, int>{"hello", "how", "are", "you?"};
+	CHECK(g.insert_edge("hello", "how", 5));
+	CHECK(g.insert_edge("hello", "are", 8));
+	CHECK(g.insert_edge("how", "you?", 1));
+	auto buffer = std::stringstream{};
+	gdwg::save(g, buffer);
+	auto m = gdwg::mapped_graph<std::string, int>(buffer);
+	CHECK(m.size() == 4);
+	CHECK(m.edge_count() == 3);
+	CHECK(m.is_node("how"));
+	CHECK(!m.is_node("who"));
+	CHECK(m.is_connected("hello", "are"));
+	CHECK(m.connections("hello") == std::vector<std::string>{"are", "how"});
+	CHECK(m.nodes() == g.nodes());
+	CHECK(text(m.to_graph()) == text(g));
+
+	auto l = gdwg::graph<label, label>{label{"x"}, label{"y"}};
+	CHECK(l.insert_edge(label{"x"}, label{"y"}, label{"edge"}));
+	auto out = std::stringstream{};
+	gdwg::save<label, label, label_codec, label_codec>(l, out);
+	auto back = gdwg::load<label, label, label_codec, label_codec>(out);
+	CHECK(back.weights(label{"x"}, label{"y"}) == std::vector<label>{label{"edge"}});
+}
+
+TEST_CASE("a mapped file answers queries in place") {
+	auto g = gdwg::graph<int, int>{};
+	for (auto i = 0; i < 100; ++i) {
+		g.insert_node(i);
+	}
+	for (auto i = 0; i < 100; ++i) {
+		g.insert_edge(i, (i * 7) % 100, i);
+		g.insert_edge(i, (i * 3) % 100, i + 1);
+	}
+	auto path = std::filesystem::temp_directory_path() / "gdwg_binary_test.bin";
+	gdwg::save(g, path);
+	{
+		auto m = gdwg::mapped_graph<int, int>(path);
+		CHECK(m.size() == 100);
+		CHECK(m.edge_count() == 200);
+		CHECK(m.is_connected(5, 35));
+		CHECK(m.weights(5, 15) == std::vector<int>{6});
+		auto gi = g.begin();
+		for (auto const& [from, to, weight] : m) {
+			CHECK(from == (*gi).from);
+			CHECK(to == (*gi).to);
+			CHECK(weight == (*gi).weight);
+			++gi;
+		}
+		// Loading with the wrong types is refused.
+		CHECK_THROWS_AS((gdwg::mapped_graph<int, double>(path)), std::runtime_error);
+	}
+	std::filesystem::remove(path);
+	auto junk = std::stringstream{"not a graph at all, just some text that is long enough"};
+	CHECK_THROWS_AS((gdwg::mapped_graph<int, int>(junk)), std::runtime_error);
+}
+
+TEST_CASE("a corrupt file is refused when it is loaded") {
+	auto g = gdwg::graph<int, int>{1, 2};
+	CHECK(g.insert_edge(1, 2, 3));
+	CHECK(g.insert_edge(2, 1, 4));
+	auto saved = std::stringstream{};
+	gdwg::save(g, saved);
+	auto const good = saved.str();
+	// The header is 48 bytes, the two nodes take one 16 byte section and the three offsets
+	// two more, so the offsets start at 64 and the destinations at 96.
+	auto corrupt = [&](std::size_t at, std::uint64_t value, std::size_t width) {
+		auto bytes = good;
+		std::memcpy(bytes.data() + at, &value, width);
+		auto is = std::istringstream(bytes);
+		return gdwg::mapped_graph<int, int>(is);
+	};
+	CHECK_NOTHROW(corrupt(16, 2, 8));
+	auto const message = std::string("Cannot load a gdwg::graph from a corrupt binary file");
+	// A node count whose sections can't be sized.
+	CHECK_THROWS_WITH(corrupt(16, std::numeric_limits<std::uint64_t>::max(), 8), message);
+	CHECK_THROWS_AS(corrupt(16, std::uint64_t{1} << 61, 8), std::runtime_error);
+	// Offsets that don't start at zero, go backwards or don't end at the edge count.
+	CHECK_THROWS_WITH(corrupt(64, 1, 8), message);
+	CHECK_THROWS_WITH(corrupt(72, 3, 8), message);
+	CHECK_THROWS_WITH(corrupt(80, 1, 8), message);
+	// An edge to a node that isn't there.
+	CHECK_THROWS_WITH(corrupt(96, 2, 4), message);
+
+	// Encoded values whose offsets leave their section.
+	auto s = gdwg::graph<std::string, int>{"a", "b"};
+	auto encoded = std::stringstream{};
+	gdwg::save(s, encoded);
+	auto bytes = encoded.str();
+	auto const past_end = std::uint64_t{1000};
+	std::memcpy(bytes.data() + 48 + 16, &past_end, sizeof(past_end));
+	auto is = std::istringstream(bytes);
+	CHECK_THROWS_AS((gdwg::mapped_graph<std::string, int>(is)), std::runtime_error);
+	bytes = encoded.str();
+	auto const backwards = std::uint64_t{0};
+	std::memcpy(bytes.data() + 48 + 8, &past_end, sizeof(past_end));
+	std::memcpy(bytes.data() + 48 + 16, &backwards, sizeof(backwards));
+	is = std::istringstream(bytes);
+	CHECK_THROWS_WITH((gdwg::mapped_graph<std::string, int>(is)), message);
+}
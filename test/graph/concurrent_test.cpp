@@ -0,0 +1,212 @@
+#include "gdwg/concurrent_graph.hpp"
+
+#include <catch2/catch.hpp>
+#include <atomic>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+// This is the CONCURRENT GRAPH TESTING file.
+
+TEST_CASE("accessors work through a const graph") {
+	auto g = gdwg::graph<std::string, int>{"A", "B", "C"};
+	CHECK(g.insert_edge("A", "B", 1));
+	CHECK(g.insert_edge("A", "B", 2));
+	auto const& cg = g;
+	CHECK(cg.is_node("A"));
+	CHECK_FALSE(cg.empty());
+	CHECK(cg.size() == 3);
+	CHECK(cg.is_connected("A", "B"));
+	CHECK(cg.nodes() == std::vector<std::string>{"A", "B", "C"});
+	CHECK(cg.weights("A", "B") == std::vector<int>{1, 2});
+	CHECK(cg.connections("A") == std::vector<std::string>{"B"});
+	CHECK(cg.in_connections("B") == std::vector<std::string>{"A"});
+	CHECK(cg.find("A", "B", 2) != cg.end());
+}
+
+TEST_CASE("writes are published as whole versions") {
+	auto cg = gdwg::concurrent_graph<std::string, int>{};
+	CHECK(cg.empty());
+	CHECK(cg.insert_node("A"));
+	CHECK(cg.insert_node("B"));
+	auto before = cg.read();
+	CHECK(cg.version() == 2);
+	cg.update([](auto& g) {
+		g.insert_edge("A", "B", 1);
+		g.insert_edge("B", "A", 1);
+	});
+	CHECK(cg.version() == 3);
+	CHECK(cg.is_connected("A", "B"));
+	CHECK(cg.is_connected("B", "A"));
+	// A version that was read earlier never changes.
+	CHECK_FALSE(before->is_connected("A", "B"));
+	CHECK(before->begin() == before->end());
+	CHECK(cg.connections("A") == std::vector<std::string>{"B"});
+}
+
+TEST_CASE("a throwing update publishes nothing") {
+	auto cg = gdwg::concurrent_graph<int, int>{gdwg::graph<int, int>{1, 2}};
+	auto before = cg.read();
+	CHECK_THROWS_AS(cg.insert_edge(1, 3, 0), std::runtime_error);
+	CHECK_THROWS_AS(cg.update([](auto& g) {
+		g.insert_edge(1, 2, 0);
+		g.insert_edge(1, 3, 0);
+	}),
+	                std::runtime_error);
+	CHECK(cg.read() == before);
+	CHECK(cg.version() == 0);
+	CHECK_FALSE(cg.is_connected(1, 2));
+}
+
+TEST_CASE("readers see consistent snapshots while a writer runs") {
+	constexpr auto n = 64;
+	auto cg = gdwg::concurrent_graph<int, int>{};
+	cg.update([](auto& g) {
+		for (auto i = 0; i < n; ++i) {
+			g.insert_node(i);
+		}
+	});
+	auto done = std::atomic<bool>{false};
+	auto torn = std::atomic<int>{0};
+	auto readers = std::vector<std::thread>{};
+	for (auto r = 0; r < 4; ++r) {
+		readers.emplace_back([&] {
+			while (!done.load()) {
+				// Every update adds or removes both directions of an edge, so a snapshot
+				// must always be symmetric.
+				auto snap = cg.read();
+				auto count = 0;
+				for (auto const& [from, to, weight] : *snap) {
+					if (!snap->is_connected(to, from)) {
+						++torn;
+					}
+					++count;
+				}
+				if (count % 2 != 0) {
+					++torn;
+				}
+			}
+		});
+	}
+	for (auto i = 0; i < 500; ++i) {
+		auto a = i % n;
+		auto b = (i * 7 + 1) % n;
+		if (a == b) {
+			continue;
+		}
+		cg.update([&](auto& g) {
+			if (g.is_connected(a, b)) {
+				g.erase_edge(a, b, 0);
+				g.erase_edge(b, a, 0);
+			}
+			else {
+				g.insert_edge(a, b, 0);
+				g.insert_edge(b, a, 0);
+			}
+		});
+	}
+	done = true;
+	for (auto& t : readers) {
+		t.join();
+	}
+	CHECK(torn == 0);
+}
+
+TEST_CASE("a run of writes is published once, by the next read") {
+	auto cg = gdwg::concurrent_graph<int, int>{};
+	auto const first = cg.read();
+	for (auto i = 0; i < 100; ++i) {
+		CHECK(cg.insert_node(i));
+	}
+	CHECK(cg.version() == 100);
+	// Nothing has been published yet, and the version read earlier is still empty.
+	CHECK(first->empty());
+	auto const all = cg.read();
+	CHECK(all != first);
+	CHECK(all->size() == 100);
+	CHECK(cg.read() == all);
+	// A write that changes nothing doesn't need publishing.
+	CHECK_FALSE(cg.insert_node(5));
+	CHECK(cg.version() == 101);
+	CHECK(cg.read() == all);
+	cg.update([](auto&) {});
+	CHECK(cg.read() == all);
+
+	CHECK(cg.insert_edge(1, 2, 3));
+	CHECK(cg.is_connected(1, 2));
+	CHECK_FALSE(all->is_connected(1, 2));
+}
+
+TEST_CASE("single writes from several threads all land") {
+	constexpr auto n = 40;
+	auto cg = gdwg::concurrent_graph<int, int>{};
+	cg.update([](auto& g) {
+		for (auto i = 0; i < n; ++i) {
+			g.insert_node(i);
+		}
+	});
+	auto done = std::atomic<bool>{false};
+	auto shrank = std::atomic<int>{0};
+	auto readers = std::vector<std::thread>{};
+	for (auto r = 0; r < 2; ++r) {
+		readers.emplace_back([&] {
+			auto last = std::size_t{0};
+			while (!done.load()) {
+				auto snap = cg.read();
+				auto count = static_cast<std::size_t>(std::distance(snap->begin(), snap->end()));
+				if (count < last) {
+					++shrank;
+				}
+				last = count;
+			}
+		});
+	}
+	auto writers = std::vector<std::thread>{};
+	for (auto w = 0; w < 3; ++w) {
+		writers.emplace_back([&cg, w] {
+			for (auto i = 0; i < n; ++i) {
+				cg.insert_edge(i, (i + w + 1) % n, w);
+			}
+		});
+	}
+	for (auto& t : writers) {
+		t.join();
+	}
+	done = true;
+	for (auto& t : readers) {
+		t.join();
+	}
+	CHECK(shrank == 0);
+	auto const snap = cg.read();
+	CHECK(std::distance(snap->begin(), snap->end()) == 3 * n);
+	CHECK(cg.version() == 1 + 3 * n);
+}
+
+TEST_CASE("a read doesn't wait for a write in progress") {
+	auto cg = gdwg::concurrent_graph<int, int>(gdwg::graph<int, int>{1, 2});
+	auto const before = cg.read();
+	CHECK(cg.insert_edge(1, 2, 0));
+	auto started = std::atomic<bool>{false};
+	auto finish = std::atomic<bool>{false};
+	auto writer = std::thread([&] {
+		cg.update([&](auto& g) {
+			g.insert_edge(2, 1, 0);
+			started = true;
+			while (!finish.load()) {
+				std::this_thread::yield();
+			}
+		});
+	});
+	while (!started.load()) {
+		std::this_thread::yield();
+	}
+	// The writer holds the lock, so the read gets the last published version instead.
+	CHECK(cg.read() == before);
+	finish = true;
+	writer.join();
+	// The writer published on its way out, because a reader asked for it.
+	auto const after = cg.read();
+	CHECK(after->is_connected(1, 2));
+	CHECK(after->is_connected(2, 1));
+}
@@ -0,0 +1,77 @@
+#include "gdwg/graph.hpp"
+
+#include <catch2/catch.hpp>
+#include <iostream>
+#include <sstream>
+
+// This is the FROZEN (CSR) SNAPSHOT TESTING file.
+
+TEST_CASE("freeze keeps the nodes and edges of the graph") {
+	auto g = gdwg::graph<std::string, int>{"hello", "how", "are", "you?"};
+	CHECK(g.insert_edge("hello", "how", 5));
+	CHECK(g.insert_edge("hello", "are", 8));
+	CHECK(g.insert_edge("hello", "are", 2));
+	CHECK(g.insert_edge("how", "you?", 1));
+	CHECK(g.insert_edge("how", "hello", 4));
+	CHECK(g.insert_edge("are", "you?", 3));
+	auto f = g.freeze();
+	CHECK(f.size() == 4);
+	CHECK(f.edge_count() == 6);
+	CHECK(f.nodes() == g.nodes());
+	CHECK(f.is_node("how"));
+	CHECK(!f.is_node("who"));
+	CHECK(f.is_connected("hello", "are"));
+	CHECK(!f.is_connected("are", "hello"));
+	CHECK(f.weights("hello", "are") == g.weights("hello", "are"));
+	CHECK(f.connections("hello") == g.connections("hello"));
+	CHECK(f.connections("you?").empty());
+	CHECK_THROWS_AS(f.is_connected("who", "hello"), std::runtime_error);
+	// The CSR arrays line up with the dense IDs.
+	CHECK(f.offsets().size() == 5);
+	CHECK(f.node(f.node_id("are")) == "are");
+	CHECK(f.node(f.destinations()[0]) == "you?");
+	CHECK(f.edge_weights()[0] == 3);
+}
+
+TEST_CASE("frozen iteration matches graph iteration") {
+	auto g = gdwg::graph<int, std::string>{1, 5, 7, 4, 8, 9};
+	// 1 is left without edges so the first edge is not on the first node.
+	CHECK(g.insert_edge(4, 8, "d"));
+	CHECK(g.insert_edge(5, 4, "b"));
+	CHECK(g.insert_edge(5, 4, "a"));
+	CHECK(g.insert_edge(8, 9, "e"));
+	auto f = g.freeze();
+	auto gi = g.begin();
+	for (auto const& [from, to, weight] : f) {
+		CHECK(from == (*gi).from);
+		CHECK(to == (*gi).to);
+		CHECK(weight == (*gi).weight);
+		++gi;
+	}
+	CHECK(gi == g.end());
+	// Walk backwards from the end as well.
+	auto fi = f.end();
+	--fi;
+	CHECK((*fi).from == 8);
+	CHECK((*fi).to == 9);
+	--fi;
+	--fi;
+	CHECK((*fi).from == 5);
+	CHECK((*fi).weight == "a");
+	--fi;
+	CHECK(fi == f.begin());
+	// Both print the same text.
+	auto gs = std::ostringstream{};
+	auto fs = std::ostringstream{};
+	gs << g;
+	fs << f;
+	CHECK(gs.str() == fs.str());
+}
+
+TEST_CASE("freezing an empty graph") {
+	auto g = gdwg::graph<int, int>{};
+	auto f = g.freeze();
+	CHECK(f.empty());
+	CHECK(f.begin() == f.end());
+	CHECK(g.begin() == g.end());
+}
@@ -0,0 +1,142 @@
+#include "gdwg/graph.hpp"
+
+#include <algorithm>
+#include <catch2/catch.hpp>
+#include <memory_resource>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+// This is the INLINE EDGE STORAGE TESTING file.
+
+namespace {
+	template<typename T>
+	using small_vector = gdwg::detail::small_vector<T, 4, std::allocator<T>>;
+
+	template<typename V>
+	auto contents(V const& v) {
+		return std::vector<typename V::value_type>(v.begin(), v.end());
+	}
+} // namespace
+
+TEMPLATE_TEST_CASE("small_vector keeps its first elements inline", "", int, std::string) {
+	auto make = [](int i) {
+		if constexpr (std::is_same_v<TestType, int>) {
+			return i;
+		}
+		else {
+			return std::string(20, static_cast<char>('a' + i));
+		}
+	};
+	auto v = small_vector<TestType>{};
+	auto expected = std::vector<TestType>{};
+	for (auto i = 0; i < 4; ++i) {
+		// Insert at the front so every insert shifts what is there.
+		v.insert(v.begin(), make(i));
+		expected.insert(expected.begin(), make(i));
+	}
+	CHECK(!v.on_heap());
+	CHECK(contents(v) == expected);
+
+	auto const more = expected;
+	v.insert(v.begin() + 2, more.begin(), more.end());
+	expected.insert(expected.begin() + 2, more.begin(), more.end());
+	CHECK(v.on_heap());
+	CHECK(contents(v) == expected);
+
+	v.erase(v.begin() + 1, v.begin() + 5);
+	expected.erase(expected.begin() + 1, expected.begin() + 5);
+	v.erase(v.end() - 1);
+	expected.pop_back();
+	CHECK(contents(v) == expected);
+
+	auto copy = v;
+	auto moved = std::move(v);
+	CHECK(v.empty());
+	CHECK(contents(copy) == expected);
+	CHECK(contents(moved) == expected);
+	moved = small_vector<TestType>{};
+	moved.insert(moved.end(), make(9));
+	copy = std::move(moved);
+	CHECK(contents(copy) == std::vector<TestType>{make(9)});
+	CHECK(!copy.on_heap());
+}
+
+TEST_CASE("a node's edges only leave the inline storage past the threshold") {
+	auto g = gdwg::graph<int, std::string>{1, 2, 3, 4, 5, 6};
+	for (auto dst = 6; dst >= 3; --dst) {
+		CHECK(g.insert_edge(1, dst, "w"));
+	}
+	auto const& edges = g.out_edges(g.node_id(1));
+	CHECK(!edges.on_heap());
+	CHECK(g.connections(1) == std::vector<int>{3, 4, 5, 6});
+
+	CHECK(g.insert_edge(1, 2, "x"));
+	CHECK(g.insert_edge(1, 2, "a"));
+	CHECK(g.out_edges(g.node_id(1)).on_heap());
+	CHECK(g.weights(1, 2) == std::vector<std::string>{"a", "x"});
+
+	// A copy shares the block until either side changes it.
+	auto copy = g;
+	CHECK(copy.erase_node(2));
+	CHECK(g.connections(1) == std::vector<int>{2, 3, 4, 5, 6});
+	CHECK(copy.connections(1) == std::vector<int>{3, 4, 5, 6});
+}
+
+TEST_CASE("a graph's edges are shifted as raw bytes when the weight allows it") {
+	auto g = gdwg::graph<int, int>{0};
+	using edge = typename std::remove_cvref_t<decltype(g.out_edges(g.node_id(0)))>::value_type;
+	STATIC_REQUIRE(std::is_trivially_copyable_v<edge>);
+	auto s = gdwg::graph<int, std::string>{0};
+	using string_edge =
+	   typename std::remove_cvref_t<decltype(s.out_edges(s.node_id(0)))>::value_type;
+	STATIC_REQUIRE(!std::is_trivially_copyable_v<string_edge>);
+
+	// Every insert lands in the middle of the block, before and after it spills.
+	auto expected = std::vector<std::tuple<int, int, int>>{};
+	for (auto i = 0; i < 20; ++i) {
+		auto dst = (i * 7) % 20 + 1;
+		g.insert_node(dst);
+		CHECK(g.insert_edge(0, dst, i + 1));
+		CHECK(g.insert_edge(0, dst, -i - 1));
+		expected.emplace_back(0, dst, i + 1);
+		expected.emplace_back(0, dst, -i - 1);
+	}
+	CHECK(g.out_edges(g.node_id(0)).on_heap());
+	auto const copy = g;
+	auto const all = expected;
+	for (auto i = std::size_t{0}; i < all.size(); i += 3) {
+		auto const& [from, to, weight] = all[i];
+		CHECK(g.erase_edge(from, to, weight));
+		std::erase(expected, all[i]);
+	}
+	// Renaming a destination rotates its run of edges to where the new value sorts.
+	CHECK(g.replace_node(5, 50));
+	for (auto& [from, to, weight] : expected) {
+		to = to == 5 ? 50 : to;
+	}
+	std::sort(expected.begin(), expected.end(), [](auto const& a, auto const& b) {
+		return std::tuple(std::get<1>(a), std::get<2>(a))
+		       < std::tuple(std::get<1>(b), std::get<2>(b));
+	});
+	auto edges = std::vector<std::tuple<int, int, int>>{};
+	for (auto const& [from, to, weight] : g) {
+		edges.emplace_back(from, to, weight);
+	}
+	CHECK(edges == expected);
+	// The copy kept its own block.
+	CHECK(copy.is_node(5));
+	CHECK(std::distance(copy.begin(), copy.end()) == 40);
+}
+
+TEST_CASE("spilled edges come from the graph's allocator") {
+	auto pool = std::pmr::monotonic_buffer_resource{};
+	auto g = gdwg::pmr::graph<int, int>(&pool);
+	for (auto i = 0; i < 10; ++i) {
+		g.insert_node(i);
+		g.insert_edge(0, i, i);
+	}
+	CHECK(g.out_edges(g.node_id(0)).on_heap());
+	CHECK(g.out_edges(g.node_id(0)).get_allocator().resource() == &pool);
+}
@@ -2,6 +2,10 @@
 
 #include <catch2/catch.hpp>
 #include <iostream>
+#include <ranges>
+#include <string>
+#include <utility>
+#include <vector>
 
 // This is the ITERATOR TESTING file.
 
@@ -72,4 +76,130 @@ TEST_CASE("erase_edge(iterator) TEST") {
 	CHECK((*next).from == 5);
 	CHECK((*next).to == 4);
 	CHECK((*next).weight == "b");
-}
\ No newline at end of file
+}
+namespace {
+	// A node type that counts how many times it gets copied.
+	struct counted {
+		int value;
+		static inline int copies = 0;
+
+		counted(int v)
+		: value{v} {}
+		counted(counted const& other)
+		: value{other.value} {
+			++copies;
+		}
+		auto operator=(counted const& other) -> counted& {
+			value = other.value;
+			++copies;
+			return *this;
+		}
+		friend auto operator==(counted const& a, counted const& b) -> bool {
+			return a.value == b.value;
+		}
+		friend auto operator<(counted const& a, counted const& b) -> bool {
+			return a.value < b.value;
+		}
+	};
+} // namespace
+
+TEST_CASE("edges() walks the graph without copying") {
+	auto g = gdwg::graph<counted, int>{1, 2, 3};
+	CHECK(g.insert_edge(1, 2, 5));
+	CHECK(g.insert_edge(1, 3, 6));
+	CHECK(g.insert_edge(3, 1, 7));
+	counted::copies = 0;
+	auto total = 0;
+	for (auto [from, to, weight] : g.edges()) {
+		total += from.value * 100 + to.value * 10 + weight;
+	}
+	CHECK(total == 125 + 136 + 317);
+	CHECK(counted::copies == 0);
+	// The old iterator still hands out copies.
+	auto first = *g.begin();
+	CHECK(first.from.value == 1);
+	CHECK(counted::copies > 0);
+}
+
+TEST_CASE("edges() visits the same edges as the copying iterator") {
+	auto g = gdwg::graph<std::string, int>{"A", "B", "C", "D"};
+	CHECK(g.insert_edge("B", "A", 1));
+	CHECK(g.insert_edge("B", "C", 2));
+	CHECK(g.insert_edge("B", "C", 1));
+	CHECK(g.insert_edge("D", "D", 3));
+	auto it = g.begin();
+	for (auto [from, to, weight] : g.edges()) {
+		CHECK(from == (*it).from);
+		CHECK(to == (*it).to);
+		CHECK(weight == (*it).weight);
+		++it;
+	}
+	CHECK(it == g.end());
+	// The references point at the nodes stored in the graph.
+	auto view = g.edges();
+	auto e = view.begin();
+	CHECK(&std::get<0>(*e) == &std::get<0>(*std::next(e)));
+	auto last = view.end();
+	--last;
+	CHECK(std::get<0>(*last) == "D");
+	CHECK(std::get<2>(*last) == 3);
+	auto empty = gdwg::graph<int, int>{};
+	CHECK(empty.edges().begin() == empty.edges().end());
+}
+
+TEST_CASE("neighbour and weight views read the adjacency in place") {
+	auto g = gdwg::graph<counted, int>{1, 2, 3, 4};
+	CHECK(g.insert_edge(1, 3, 7));
+	CHECK(g.insert_edge(1, 2, 5));
+	CHECK(g.insert_edge(1, 2, 4));
+	CHECK(g.insert_edge(1, 1, 9));
+	CHECK(g.insert_edge(2, 1, 1));
+	counted::copies = 0;
+	auto neighbours = std::vector<int>{};
+	for (auto const& n : g.neighbors(1)) {
+		neighbours.push_back(n.value);
+	}
+	CHECK(neighbours == std::vector<int>{1, 2, 3});
+	auto weights = std::vector<int>{};
+	for (auto const& w : g.weights_view(1, 2)) {
+		weights.push_back(w);
+	}
+	CHECK(weights == std::vector<int>{4, 5});
+	auto edges = std::vector<std::pair<int, int>>{};
+	for (auto [to, weight] : g.out_edges(counted{1})) {
+		edges.emplace_back(to.value, weight);
+	}
+	CHECK(edges == std::vector<std::pair<int, int>>{{1, 9}, {2, 4}, {2, 5}, {3, 7}});
+	auto nodes = std::vector<int>{};
+	for (auto const& n : g.nodes_view()) {
+		nodes.push_back(n.value);
+	}
+	CHECK(nodes == std::vector<int>{1, 2, 3, 4});
+	CHECK(counted::copies == 0);
+	CHECK(g.neighbors(4).empty());
+	CHECK(g.weights_view(2, 3).empty());
+	CHECK(g.out_edges(counted{4}).empty());
+	// The views hand out references to the stored nodes.
+	CHECK(&*g.neighbors(2).begin() == &*g.nodes_view().begin());
+	CHECK_THROWS_AS(g.neighbors(5), std::runtime_error);
+	CHECK_THROWS_AS(g.weights_view(1, 5), std::runtime_error);
+	CHECK_THROWS_AS(g.out_edges(counted{5}), std::runtime_error);
+	static_assert(std::ranges::forward_range<decltype(g.neighbors(1))>);
+	static_assert(std::ranges::forward_range<decltype(g.weights_view(1, 2))>);
+}
+
+TEST_CASE("the vector accessors agree with the views") {
+	auto g = gdwg::graph<std::string, int>{"A", "B", "C"};
+	CHECK(g.insert_edge("A", "C", 2));
+	CHECK(g.insert_edge("A", "B", 3));
+	CHECK(g.insert_edge("A", "B", 1));
+	CHECK(g.insert_edge("A", "A", 1));
+	CHECK(g.connections("A") == std::vector<std::string>{"A", "B", "C"});
+	CHECK(g.weights("A", "B") == std::vector<int>{1, 3});
+	CHECK(g.weights("B", "A").empty());
+	CHECK(g.nodes() == std::vector<std::string>{"A", "B", "C"});
+	auto view = g.neighbors("A");
+	CHECK(std::vector<std::string>(view.begin(), view.end()) == g.connections("A"));
+	CHECK_THROWS_AS(g.weights("A", "D"), std::runtime_error);
+	CHECK_THROWS_AS(g.connections("D"), std::runtime_error);
+}
@@ -0,0 +1,171 @@
+#include "gdwg/binary.hpp"
+#include "gdwg/graph.hpp"
+
+#include <catch2/catch.hpp>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <variant>
+#include <vector>
+
+// This is the CHANGE JOURNAL TESTING file.
+
+namespace {
+	auto text(auto const& g) -> std::string {
+		auto os = std::ostringstream{};
+		os << g;
+		return os.str();
+	}
+} // namespace
+
+TEST_CASE("every successful change moves the version on by one") {
+	auto g = gdwg::graph<std::string, int>{"a", "b"};
+	CHECK(g.version() == 2);
+	CHECK(!g.insert_node("a"));
+	CHECK(g.version() == 2);
+	CHECK(g.insert_edge("a", "b", 1));
+	CHECK(!g.insert_edge("a", "b", 1));
+	CHECK(g.version() == 3);
+	CHECK(!g.erase_edge("a", "b", 2));
+	CHECK(g.erase_edge("a", "b", 1));
+	CHECK(g.version() == 4);
+	// A copy carries the version over.
+	auto copy = g;
+	CHECK(copy.version() == 4);
+}
+
+TEST_CASE("a delta brings a copy up to date") {
+	auto g = gdwg::graph<std::string, int>{"a", "b", "c"};
+	g.start_journal();
+	CHECK(g.is_journaling());
+	auto replica = g;
+	auto synced = replica.version();
+
+	g.insert_node("d");
+	g.insert_edge("a", "b", 1);
+	g.insert_edge("b", "c", 2);
+	g.insert_edge("c", "a", 3);
+	g.insert_edge("d", "a", 4);
+	g.replace_node("d", "e");
+	g.merge_replace_node("b", "c");
+	g.erase_edge("c", "a", 3);
+	g.erase_node("a");
+
+	auto d = g.changes_since(synced);
+	CHECK(d.from_version == synced);
+	CHECK(d.to_version == g.version());
+	CHECK(d.changes.size() == 9);
+	// The merge is one change; the edges it moves are not recorded separately.
+	CHECK(std::holds_alternative<gdwg::delta<std::string, int>::nodes_merged>(d.changes[6]));
+
+	replica.apply(d);
+	CHECK(replica.version() == g.version());
+	CHECK(text(replica) == text(g));
+	// Nothing more has happened since.
+	CHECK(g.changes_since(g.version()).changes.empty());
+}
+
+TEST_CASE("bulk inserts record only the edges that were new") {
+	auto g = gdwg::graph<int, int>{1, 2, 3};
+	g.insert_edge(1, 2, 5);
+	g.start_journal();
+	auto replica = gdwg::graph<int, int, std::allocator<int>, gdwg::hashed_lookup>{1, 2, 3};
+	replica.insert_edge(1, 2, 5);
+	auto batch =
+	   std::vector<gdwg::graph<int, int>::value_type>{{1, 2, 5}, {2, 3, 1}, {3, 1, 2}, {2, 3, 1}};
+	auto result = g.insert_edges(batch.begin(), batch.end());
+	CHECK(result.inserted == 2);
+	auto d = g.changes_since(4);
+	CHECK(d.changes.size() == 2);
+	// A delta only depends on N and E, so it applies across lookup policies.
+	replica.apply(d);
+	CHECK(text(replica) == text(g));
+}
+
+TEST_CASE("clearing is a change like any other") {
+	auto g = gdwg::graph<int, int>{1, 2};
+	g.start_journal();
+	auto replica = g;
+	g.clear();
+	g.insert_node(7);
+	replica.apply(g.changes_since(2));
+	CHECK(replica.nodes() == std::vector<int>{7});
+}
+
+TEST_CASE("the journal only covers the versions it kept") {
+	auto g = gdwg::graph<int, int>{1, 2};
+	CHECK_THROWS_AS(g.changes_since(2), std::runtime_error);
+	g.start_journal();
+	g.insert_node(3);
+	g.insert_node(4);
+	g.insert_node(5);
+	CHECK_THROWS_AS(g.changes_since(1), std::runtime_error);
+	CHECK_THROWS_AS(g.changes_since(6), std::runtime_error);
+	CHECK(g.changes_since(2).changes.size() == 3);
+
+	g.trim_journal(4);
+	CHECK_THROWS_AS(g.changes_since(3), std::runtime_error);
+	auto d = g.changes_since(4);
+	REQUIRE(d.changes.size() == 1);
+	CHECK(std::get<gdwg::delta<int, int>::node_inserted>(d.changes[0]).value == 5);
+
+	g.stop_journal();
+	CHECK(!g.is_journaling());
+	CHECK_THROWS_AS(g.changes_since(5), std::runtime_error);
+}
+
+TEST_CASE("a copy journals from the version it was copied at") {
+	auto g = gdwg::graph<int, int>{1, 2};
+	g.start_journal();
+	g.insert_node(3);
+	auto copy = g;
+	CHECK(copy.is_journaling());
+	CHECK(copy.version() == 3);
+	CHECK_THROWS_AS(copy.changes_since(2), std::runtime_error);
+	CHECK(copy.changes_since(3).changes.empty());
+	copy.insert_node(4);
+	CHECK(copy.changes_since(3).changes.size() == 1);
+	CHECK(g.changes_since(2).changes.size() == 1);
+}
+
+TEST_CASE("a delta only applies to the version it starts from") {
+	auto g = gdwg::graph<int, int>{1, 2};
+	g.start_journal();
+	auto replica = g;
+	g.insert_edge(1, 2, 3);
+	auto d = g.changes_since(2);
+	replica.insert_node(9);
+	CHECK_THROWS_AS(replica.apply(d), std::runtime_error);
+
+	// A replica at the right version but in a different state stops at the first change that
+	// doesn't apply.
+	auto other = gdwg::graph<int, int>{1, 5};
+	CHECK_THROWS_AS(other.apply(d), std::runtime_error);
+}
+
+TEST_CASE("a delta round trips through the binary format") {
+	auto g = gdwg::graph<std::string, double>{"a", "b"};
+	g.start_journal();
+	auto replica = g;
+	g.insert_node("c");
+	g.insert_edge("a", "c", 0.5);
+	g.insert_edge("c", "b", 1.5);
+	g.replace_node("b", "bb");
+	g.erase_edge("a", "c", 0.5);
+	g.merge_replace_node("a", "c");
+	g.clear();
+	g.insert_node("z");
+
+	auto os = std::ostringstream{};
+	gdwg::save(g.changes_since(2), os);
+	auto is = std::istringstream{os.str()};
+	auto d = gdwg::load_delta<std::string, double>(is);
+	CHECK(d.from_version == 2);
+	CHECK(d.to_version == g.version());
+	CHECK(d.changes.size() == 8);
+	replica.apply(d);
+	CHECK(text(replica) == text(g));
+
+	auto bad = std::istringstream{"not a delta"};
+	CHECK_THROWS_AS((gdwg::load_delta<std::string, double>(bad)), std::runtime_error);
+}
@@ -0,0 +1,118 @@
+#include "gdwg/graph.hpp"
+
+#include <catch2/catch.hpp>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// This is the HASHED LOOKUP TESTING file.
+
+template<typename N, typename E>
+using hashed_graph = gdwg::graph<N, E, std::allocator<N>, gdwg::hashed_lookup>;
+
+TEST_CASE("hashed lookup answers the same queries as ordered lookup") {
+	auto g = hashed_graph<std::string, int>{"hello", "how", "are", "you?"};
+	CHECK(g.is_node("how"));
+	CHECK(!g.is_node("who"));
+	CHECK(g.insert_edge("hello", "how", 5));
+	CHECK(g.insert_edge("hello", "are", 8));
+	CHECK(g.insert_edge("hello", "are", 2));
+	CHECK(!g.insert_edge("hello", "are", 2));
+	CHECK(g.insert_edge("how", "you?", 1));
+	CHECK(g.insert_edge("are", "are", 3));
+	CHECK(g.is_connected("hello", "are"));
+	CHECK(!g.is_connected("are", "hello"));
+	CHECK(g.is_connected("are", "are"));
+	CHECK_THROWS_AS(g.is_connected("who", "hello"), std::runtime_error);
+	CHECK(g.find("hello", "are", 8) != g.end());
+	CHECK(g.find("hello", "are", 9) == g.end());
+	CHECK(g.find("are", "hello", 8) == g.end());
+	CHECK(g.weights("hello", "are") == std::vector<int>{2, 8});
+	// Iteration and printing still come out in order.
+	auto out = std::ostringstream{};
+	out << g;
+	CHECK(out.str()
+	      == "are(\n\tare | 3\n)\nhello(\n\tare | 2\n\tare | 8\n\thow | 5\n)\nhow(\n\tyou? | 1\n)\n"
+	         "you?(\n)\n");
+	// The edge count between two nodes only drops to zero with the last edge.
+	CHECK(g.erase_edge("hello", "are", 2));
+	CHECK(g.is_connected("hello", "are"));
+	CHECK(g.erase_edge("hello", "are", 8));
+	CHECK(!g.is_connected("hello", "are"));
+}
+
+TEST_CASE("hashed lookup follows nodes that are renamed, merged and erased") {
+	auto g = hashed_graph<std::string, int>{"A", "B", "C"};
+	CHECK(g.insert_edge("A", "B", 1));
+	CHECK(g.insert_edge("C", "A", 2));
+	CHECK(g.replace_node("A", "D"));
+	CHECK(!g.is_node("A"));
+	CHECK(g.is_node("D"));
+	CHECK(g.is_connected("D", "B"));
+	CHECK(g.is_connected("C", "D"));
+	g.merge_replace_node("D", "B");
+	CHECK(!g.is_node("D"));
+	CHECK(g.is_connected("B", "B"));
+	CHECK(g.is_connected("C", "B"));
+	CHECK(g.erase_node("B"));
+	CHECK(!g.is_node("B"));
+	CHECK(g.connections("C").empty());
+	// The freed ID goes to a new node, which must not inherit the old edges.
+	CHECK(g.insert_node("E"));
+	CHECK(!g.is_connected("C", "E"));
+	auto copy = g;
+	g.clear();
+	CHECK(!g.is_node("C"));
+	CHECK(copy.is_node("C"));
+	CHECK(copy.is_node("E"));
+	CHECK(g.insert_node("C"));
+	CHECK(g.is_node("C"));
+}
+
+TEST_CASE("hashed and ordered lookup agree on random workloads") {
+	constexpr auto n = 200;
+	auto ordered = gdwg::graph<int, int>{};
+	auto hashed = hashed_graph<int, int>{};
+	auto rng = std::mt19937{7};
+	auto pick = std::uniform_int_distribution<int>{0, n - 1};
+	auto op = std::uniform_int_distribution<int>{0, 9};
+	for (auto i = 0; i < n; ++i) {
+		CHECK(ordered.insert_node(i) == hashed.insert_node(i));
+	}
+	for (auto step = 0; step < 20000; ++step) {
+		auto a = pick(rng);
+		auto b = pick(rng);
+		auto w = pick(rng) % 3;
+		switch (op(rng)) {
+		case 0:
+			CHECK(ordered.erase_node(a) == hashed.erase_node(a));
+			break;
+		case 1:
+			CHECK(ordered.insert_node(a) == hashed.insert_node(a));
+			break;
+		case 2:
+		case 3:
+			if (ordered.is_node(a) && ordered.is_node(b)) {
+				CHECK(ordered.erase_edge(a, b, w) == hashed.erase_edge(a, b, w));
+			}
+			break;
+		default:
+			if (ordered.is_node(a) && ordered.is_node(b)) {
+				CHECK(ordered.insert_edge(a, b, w) == hashed.insert_edge(a, b, w));
+			}
+			break;
+		}
+		CHECK(ordered.is_node(a) == hashed.is_node(a));
+		if (ordered.is_node(a) && ordered.is_node(b)) {
+			CHECK(ordered.is_connected(a, b) == hashed.is_connected(a, b));
+			CHECK((ordered.find(a, b, w) == ordered.end()) == (hashed.find(a, b, w) == hashed.end()));
+		}
+	}
+	CHECK(ordered.nodes() == hashed.nodes());
+	for (auto a : ordered.nodes()) {
+		for (auto b : ordered.nodes()) {
+			REQUIRE(ordered.is_connected(a, b) == hashed.is_connected(a, b));
+		}
+	}
+}
@@ -0,0 +1,96 @@
+#include "gdwg/max_flow.hpp"
+
+#include <catch2/catch.hpp>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+// This is the MAXIMUM FLOW TESTING file.
+
+namespace {
+	// Checks that the flow respects every capacity, is conserved at every node but src and
+	// dst, and fills the cut it reports, which makes it a maximum flow.
+	template<typename G, typename Flow, typename Capacity>
+	auto check_flow(G const& g, Flow const& flow, int src, int dst, Capacity capacity) -> void {
+		auto net = std::map<int, double>{};
+		auto cut = 0.0;
+		auto on_source_side = [&](int n) {
+			return std::binary_search(flow.source_side.begin(), flow.source_side.end(), n);
+		};
+		auto e = std::size_t{0};
+		for (auto const& [from, to, weight] : g) {
+			auto f = flow.edge_flow[e++];
+			CHECK(f >= 0);
+			CHECK(f <= capacity(weight));
+			net[from] -= f;
+			net[to] += f;
+			if (on_source_side(from) && !on_source_side(to)) {
+				cut += capacity(weight);
+			}
+		}
+		REQUIRE(e == flow.edge_flow.size());
+		for (auto const& [n, balance] : net) {
+			if (n != src && n != dst) {
+				CHECK(balance == Approx(0.0).margin(1e-9));
+			}
+		}
+		CHECK(net[dst] == Approx(flow.value));
+		CHECK(cut == Approx(flow.value));
+		CHECK(on_source_side(src));
+		CHECK(!on_source_side(dst));
+	}
+} // namespace
+
+TEST_CASE("max_flow on the textbook network") {
+	auto g = gdwg::graph<int, int>{0, 1, 2, 3, 4, 5};
+	CHECK(g.insert_edge(0, 1, 16));
+	CHECK(g.insert_edge(0, 2, 13));
+	CHECK(g.insert_edge(1, 3, 12));
+	CHECK(g.insert_edge(2, 1, 4));
+	CHECK(g.insert_edge(2, 4, 14));
+	CHECK(g.insert_edge(3, 2, 9));
+	CHECK(g.insert_edge(3, 5, 20));
+	CHECK(g.insert_edge(4, 3, 7));
+	CHECK(g.insert_edge(4, 5, 4));
+	auto flow = gdwg::max_flow(g, 0, 5);
+	CHECK(flow.value == 23);
+	check_flow(g, flow, 0, 5, [](int w) { return w; });
+	CHECK(gdwg::max_flow(g, 5, 0).value == 0);
+	CHECK_THROWS_AS(gdwg::max_flow(g, 0, 0), std::runtime_error);
+	CHECK_THROWS_AS(gdwg::max_flow(g, 0, 9), std::runtime_error);
+	CHECK(g.insert_edge(1, 2, -1));
+	CHECK_THROWS_AS(gdwg::max_flow(g, 0, 5), std::runtime_error);
+}
+
+TEST_CASE("a capacity view reads the capacity out of each weight") {
+	auto g = gdwg::graph<std::string, std::string>{"s", "a", "t"};
+	CHECK(g.insert_edge("s", "a", "10:fibre"));
+	CHECK(g.insert_edge("s", "a", "5:copper"));
+	CHECK(g.insert_edge("a", "t", "7:fibre"));
+	auto capacity = [](std::string const& w) { return std::stod(w.substr(0, w.find(':'))); };
+	auto flow = gdwg::max_flow(g, std::string("s"), std::string("t"), capacity);
+	CHECK(flow.value == 7.0);
+	CHECK(flow.source_side == std::vector<std::string>{"a", "s"});
+}
+
+TEST_CASE("max_flow gives a maximum flow on random networks") {
+	auto rng = std::mt19937{6771};
+	auto node = std::uniform_int_distribution<int>{0, 299};
+	auto weight = std::uniform_int_distribution<int>{0, 50};
+	auto g = gdwg::graph<int, int>{};
+	for (auto i = 0; i < 300; ++i) {
+		g.insert_node(i);
+	}
+	for (auto i = 0; i < 3000; ++i) {
+		g.insert_edge(node(rng), node(rng), weight(rng));
+	}
+	for (auto [src, dst] : {std::pair{0, 1}, std::pair{17, 250}, std::pair{299, 3}}) {
+		auto flow = gdwg::max_flow(g, src, dst);
+		CHECK(flow.value > 0);
+		check_flow(g, flow, src, dst, [](int w) { return w; });
+	}
+	auto halved = gdwg::max_flow(g, 0, 1, [](int w) { return w / 2.0; });
+	CHECK(halved.value == Approx(gdwg::max_flow(g, 0, 1).value / 2.0));
+	check_flow(g, halved, 0, 1, [](int w) { return w / 2.0; });
+}
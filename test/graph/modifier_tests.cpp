@@ -1,10 +1,65 @@
 #include "gdwg/graph.hpp"
 
 #include <catch2/catch.hpp>
+#include <functional>
 #include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
 
 // This is the MODIFIER TESTING file.
 
+namespace {
+	// A node value whose copies throw while fail is set. Moving it never throws.
+	struct fragile {
+		static inline auto fail = false;
+		int value;
+
+		fragile(int v)
+		: value{v} {}
+		fragile(fragile const& other)
+		: value{other.value} {
+			if (fail) {
+				throw std::runtime_error("fragile copy");
+			}
+		}
+		fragile(fragile&&) noexcept = default;
+		auto operator=(fragile const& other) -> fragile& {
+			if (fail) {
+				throw std::runtime_error("fragile copy");
+			}
+			value = other.value;
+			return *this;
+		}
+		auto operator=(fragile&&) noexcept -> fragile& = default;
+		~fragile() = default;
+
+		friend auto operator==(fragile const& a, fragile const& b) -> bool {
+			return a.value == b.value;
+		}
+		friend auto operator<(fragile const& a, fragile const& b) -> bool {
+			return a.value < b.value;
+		}
+		friend auto operator<<(std::ostream& os, fragile const& f) -> std::ostream& {
+			return os << f.value;
+		}
+	};
+
+	auto text(auto const& g) -> std::string {
+		auto os = std::ostringstream{};
+		os << g;
+		return os.str();
+	}
+} // namespace
+
+template<>
+struct std::hash<fragile> {
+	auto operator()(fragile const& f) const noexcept -> std::size_t {
+		return std::hash<int>{}(f.value);
+	}
+};
+
 // In this test case we will be checking if insert edge works.
 // We will also be testing all the different types of accessors to check if they work.
 TEST_CASE("test to see insert_edge work") {
@@ -49,10 +104,77 @@ TEST_CASE("Replace Node Test") {
 	// But 2 does not exist.
 	CHECK(g.replace_node(1, 20));
 	// now check if it has been replaces using accessor.
+	// 20 is re-keyed, so it moves to where it sorts.
 	auto v = g.nodes();
-	CHECK(v[0] == 20);
-	CHECK(v[3] == 7);
+	CHECK(v[0] == 4);
+	CHECK(v[2] == 7);
+	CHECK(v[4] == 20);
 	CHECK(v.size() == 5);
+	CHECK(g.is_connected(20, 4));
+	CHECK(g.weights(20, 4).size() == 2);
+}
+
+TEST_CASE("Replace Node keeps the edges into it in order") {
+	auto g = gdwg::graph<int, int>{1, 2, 3, 4, 5};
+	CHECK(g.insert_edge(1, 2, 7));
+	CHECK(g.insert_edge(1, 3, 8));
+	CHECK(g.insert_edge(1, 5, 9));
+	CHECK(g.insert_edge(3, 3, 1));
+	CHECK(g.insert_edge(3, 4, 2));
+	CHECK(g.insert_edge(5, 2, 3));
+	// 2 sorts last after the rename, and 3 sorts first.
+	CHECK(g.replace_node(2, 6));
+	CHECK(g.replace_node(3, 0));
+	auto v = g.nodes();
+	CHECK(v == std::vector<int>{0, 1, 4, 5, 6});
+	CHECK(g.connections(1) == std::vector<int>{0, 5, 6});
+	CHECK(g.connections(0) == std::vector<int>{0, 4});
+	CHECK(g.weights(1, 6) == std::vector<int>{7});
+	CHECK(g.weights(0, 0) == std::vector<int>{1});
+	CHECK(g.is_connected(5, 6));
+	// The edges still come out in order and can be found again.
+	CHECK(g.find(1, 0, 8) != g.end());
+	CHECK(g.erase_edge(1, 6, 7));
+	CHECK(g.connections(1) == std::vector<int>{0, 5});
+}
+
+TEMPLATE_TEST_CASE("Replace Node leaves the graph as it was if a copy throws",
+                   "",
+                   gdwg::ordered_lookup,
+                   gdwg::hashed_lookup) {
+	using graph = gdwg::graph<fragile, int, std::allocator<fragile>, TestType>;
+	auto g = graph{1, 2, 3};
+	CHECK(g.insert_edge(1, 2, 7));
+	CHECK(g.insert_edge(3, 2, 8));
+	CHECK(g.insert_edge(2, 2, 9));
+	CHECK(g.insert_edge(2, 1, 1));
+	auto const before = text(g);
+	auto check_unchanged = [&](graph const& h) {
+		CHECK(text(h) == before);
+		CHECK(h.is_node(2));
+		CHECK_FALSE(h.is_node(5));
+		CHECK(h.is_connected(3, 2));
+		CHECK(h.find(1, 2, 7) != h.end());
+	};
+	fragile::fail = true;
+	// Nothing else shares the node, so the value would be overwritten in place.
+	CHECK_THROWS_AS(g.replace_node(2, 5), std::runtime_error);
+	check_unchanged(g);
+	// A copy shares the node and its edge blocks, so the value would be replaced.
+	fragile::fail = false;
+	auto copy = g;
+	fragile::fail = true;
+	CHECK_THROWS_AS(g.replace_node(2, 5), std::runtime_error);
+	check_unchanged(g);
+	check_unchanged(copy);
+	fragile::fail = false;
+
+	CHECK(g.replace_node(2, 5));
+	CHECK(g.connections(3) == std::vector<fragile>{5});
+	CHECK(g.weights(5, 5) == std::vector<int>{9});
+	CHECK(g.is_connected(1, 5));
+	CHECK_FALSE(g.is_node(2));
+	check_unchanged(copy);
 }
 
 TEST_CASE("Merge Replace Test") {
@@ -107,4 +229,141 @@ TEST_CASE("erase node and erase edge test") {
 	// Now we test the function that deletes the whole map/graph.
 	g.clear();
 	CHECK(g.size() == 0);
-}
\ No newline at end of file
+}
+TEST_CASE("node IDs and the ID overloads") {
+	auto g = gdwg::graph<std::string, int>{"A", "B", "C"};
+	auto a = g.node_id("A");
+	auto b = g.node_id("B");
+	auto c = g.node_id("C");
+	// Every node gets its own ID and we can get the node back from it.
+	CHECK(a != b);
+	CHECK(b != c);
+	CHECK(g.node(b) == "B");
+	CHECK_THROWS_AS(g.node_id("Z"), std::runtime_error);
+	// Edges added by ID are the same edges as the ones added by value.
+	CHECK(g.insert_edge(a, b, 1));
+	CHECK(!g.insert_edge("A", "B", 1));
+	CHECK(g.insert_edge("A", "C", 2));
+	CHECK(g.is_connected(a, b));
+	CHECK(g.is_connected(a, c));
+	CHECK(!g.is_connected(b, a));
+	CHECK(g.weights("A", "B") == std::vector<int>{1});
+	// IDs stay the same while other nodes come and go.
+	CHECK(g.erase_node("B"));
+	CHECK(!g.is_node(b));
+	CHECK_THROWS_AS(g.is_connected(a, b), std::runtime_error);
+	CHECK_THROWS_AS(g.insert_edge(a, b, 3), std::runtime_error);
+	CHECK(g.node_id("A") == a);
+	CHECK(g.node_id("C") == c);
+	// A copy keeps the same IDs.
+	CHECK(g.insert_node("D"));
+	auto h = g;
+	CHECK(h.node_id("D") == g.node_id("D"));
+	CHECK(h.is_connected(a, c));
+}
+
+TEST_CASE("in_connections and the reverse index") {
+	auto g = gdwg::graph<std::string, int>{"A", "B", "C", "D"};
+	CHECK(g.insert_edge("C", "A", 1));
+	CHECK(g.insert_edge("B", "A", 2));
+	CHECK(g.insert_edge("B", "A", 3));
+	CHECK(g.insert_edge("A", "A", 4));
+	CHECK(g.insert_edge("A", "D", 5));
+	// Sources come back sorted and without duplicates.
+	CHECK(g.in_connections("A") == std::vector<std::string>{"A", "B", "C"});
+	CHECK(g.in_connections("B").empty());
+	CHECK_THROWS_AS(g.in_connections("Z"), std::runtime_error);
+	// B still points at A until both of its edges are gone.
+	CHECK(g.erase_edge("B", "A", 2));
+	CHECK(g.in_connections("A") == std::vector<std::string>{"A", "B", "C"});
+	CHECK(g.erase_edge("B", "A", 3));
+	CHECK(g.in_connections("A") == std::vector<std::string>{"A", "C"});
+	// Erasing A removes it from everyone else's index too.
+	CHECK(g.erase_node("A"));
+	CHECK(g.connections("C").empty());
+	CHECK(g.in_connections("D").empty());
+	CHECK(!g.erase_node("A"));
+}
+
+TEST_CASE("merge_replace_node redirects every edge of the old node") {
+	auto g = gdwg::graph<std::string, int>{"A", "B", "C"};
+	CHECK(g.insert_edge("A", "A", 1));
+	CHECK(g.insert_edge("B", "A", 2));
+	CHECK(g.insert_edge("C", "A", 3));
+	CHECK(g.insert_edge("A", "C", 4));
+	g.merge_replace_node("A", "B");
+	CHECK(!g.is_node("A"));
+	// A -> A and B -> A both end up as B -> B.
+	CHECK(g.weights("B", "B") == std::vector<int>{1, 2});
+	CHECK(g.weights("C", "B") == std::vector<int>{3});
+	CHECK(g.weights("B", "C") == std::vector<int>{4});
+	CHECK(g.in_connections("B") == std::vector<std::string>{"B", "C"});
+	CHECK(g.in_connections("C") == std::vector<std::string>{"B"});
+}
+
+TEST_CASE("insert_edges loads a batch and counts the duplicates") {
+	using graph = gdwg::graph<std::string, int>;
+	auto g = graph{"A", "B", "C"};
+	CHECK(g.insert_edge("A", "B", 1));
+	auto batch = std::vector<graph::value_type>{
+	   {"B", "C", 2},
+	   {"A", "C", 3},
+	   {"A", "B", 1}, // already in the graph
+	   {"A", "B", 4},
+	   {"B", "C", 2}, // repeated in the batch
+	   {"C", "A", 5},
+	};
+	auto result = g.insert_edges(batch.begin(), batch.end());
+	CHECK(result.inserted == 4);
+	CHECK(result.duplicates == 2);
+	CHECK(g.weights("A", "B") == std::vector<int>{1, 4});
+	CHECK(g.is_connected("B", "C"));
+	CHECK(g.in_connections("C") == std::vector<std::string>{"A", "B"});
+	// A batch with an unknown node leaves the graph alone.
+	auto bad = std::vector<graph::value_type>{{"A", "C", 9}, {"A", "Z", 1}};
+	CHECK_THROWS_AS(g.insert_edges(bad.begin(), bad.end()), std::runtime_error);
+	CHECK(g.weights("A", "C") == std::vector<int>{3});
+}
+
+TEST_CASE("insert_edges fills the block of one interned node") {
+	using graph = gdwg::graph<std::string, int>;
+	auto g = graph{"A", "B", "C"};
+	auto const a = g.node_id("A");
+	auto const b = g.node_id("B");
+	auto const c = g.node_id("C");
+	// Out of order, with a repeat: sorted before it goes in.
+	auto batch = std::vector<std::pair<graph::id_type, int>>{{c, 2}, {b, 7}, {a, 1}, {b, 3}, {c, 2}};
+	auto result = g.insert_edges(a, batch.begin(), batch.end());
+	CHECK(result.inserted == 4);
+	CHECK(result.duplicates == 1);
+	CHECK(g.connections("A") == std::vector<std::string>{"A", "B", "C"});
+	CHECK(g.weights("A", "B") == std::vector<int>{3, 7});
+	CHECK(g.in_connections("B") == std::vector<std::string>{"A"});
+	CHECK(g.erase_node("B"));
+	CHECK(g.connections("A") == std::vector<std::string>{"A", "C"});
+
+	// A node that already has edges only takes the new ones.
+	auto more = std::vector<std::pair<graph::id_type, int>>{{c, 2}, {c, 5}};
+	result = g.insert_edges(a, more.begin(), more.end());
+	CHECK(result.inserted == 1);
+	CHECK(result.duplicates == 1);
+	CHECK(g.weights("A", "C") == std::vector<int>{2, 5});
+
+	auto bad = std::vector<std::pair<graph::id_type, int>>{{c, 9}, {b, 1}};
+	CHECK_THROWS_AS(g.insert_edges(c, bad.begin(), bad.end()), std::runtime_error);
+	CHECK(g.connections("C").empty());
+}
+
+TEST_CASE("constructing a graph from a range of edges") {
+	using graph = gdwg::graph<int, int>;
+	auto edges = std::vector<graph::value_type>{{3, 1, 7}, {1, 2, 5}, {1, 2, 5}, {2, 3, 6}};
+	auto g = graph(edges.begin(), edges.end());
+	CHECK(g.size() == 3);
+	CHECK(g.is_connected(1, 2));
+	CHECK(g.is_connected(3, 1));
+	CHECK(g.weights(1, 2) == std::vector<int>{5});
+	// The node range constructor still works the same way.
+	auto nodes = std::vector<int>{4, 5};
+	auto h = graph(nodes.begin(), nodes.end());
+	CHECK(h.size() == 2);
+}
@@ -0,0 +1,137 @@
+#include "gdwg/graph.hpp"
+
+#include <algorithm>
+#include <catch2/catch.hpp>
+#include <iterator>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+// This is the ORDERED RANGE QUERY TESTING file.
+
+namespace {
+	// value_type has no operator==, so the edges are compared as tuples.
+	auto edge(auto const& e) {
+		return std::tuple(e.from, e.to, e.weight);
+	}
+
+	template<typename It>
+	auto collect(std::pair<It, It> range) {
+		auto out = std::vector<decltype(edge(*range.first))>{};
+		for (auto i = range.first; i != range.second; ++i) {
+			out.push_back(edge(*i));
+		}
+		return out;
+	}
+} // namespace
+
+TEST_CASE("lower_bound and upper_bound find positions in the edges leaving src") {
+	auto g = gdwg::graph<int, int>{1, 2, 4, 6, 9};
+	CHECK(g.insert_edge(1, 2, 5));
+	CHECK(g.insert_edge(1, 4, 1));
+	CHECK(g.insert_edge(1, 4, 3));
+	CHECK(g.insert_edge(1, 4, 8));
+	CHECK(g.insert_edge(1, 6, 2));
+	CHECK(g.insert_edge(2, 1, 7));
+
+	auto i = g.lower_bound(1, 4);
+	CHECK((*i).to == 4);
+	CHECK((*i).weight == 1);
+	// 3 isn't a node, so this is the first edge to a node after it.
+	CHECK(g.lower_bound(1, 3) == i);
+	CHECK(g.upper_bound(1, 2) == i);
+
+	auto j = g.upper_bound(1, 4);
+	CHECK((*j).to == 6);
+	CHECK(g.lower_bound(1, 4, 4) == g.find(1, 4, 8));
+	CHECK(g.upper_bound(1, 4, 3) == g.find(1, 4, 8));
+	CHECK(g.lower_bound(1, 4, 3) == g.find(1, 4, 3));
+
+	// Past the last edge of 1 is the first edge of the next node with any.
+	CHECK(g.upper_bound(1, 9) == g.find(2, 1, 7));
+	CHECK(g.lower_bound(2, 5) == g.end());
+	CHECK(g.lower_bound(9, 1) == g.end());
+}
+
+TEST_CASE("edges_between picks out the edges to dst with a weight in [lo, hi)") {
+	auto g = gdwg::graph<std::string, double>{"a", "b", "c"};
+	for (auto w : {0.5, 1.0, 1.5, 2.0, 2.5}) {
+		CHECK(g.insert_edge("a", "b", w));
+	}
+	CHECK(g.insert_edge("a", "a", 1.0));
+	CHECK(g.insert_edge("a", "c", 1.0));
+
+	auto weights = [](auto const& edges) {
+		auto out = std::vector<double>{};
+		for (auto const& e : edges) {
+			out.push_back(std::get<2>(e));
+		}
+		return out;
+	};
+	CHECK(weights(collect(g.edges_between("a", "b", 1.0, 2.0))) == std::vector<double>{1.0, 1.5});
+	CHECK(weights(collect(g.edges_between("a", "b", 0.7, 9.0)))
+	      == std::vector<double>{1.0, 1.5, 2.0, 2.5});
+	CHECK(collect(g.edges_between("a", "b", 2.0, 2.0)).empty());
+	CHECK(collect(g.edges_between("a", "b", 3.0, 1.0)).empty());
+	CHECK(weights(collect(g.edges_between("a", "b"))) == std::vector<double>{0.5, 1.0, 1.5, 2.0, 2.5});
+	CHECK(collect(g.edges_between("a", "bb")).empty());
+	CHECK(collect(g.edges_between("b", "a")).empty());
+	CHECK(collect(g.edges_from("a")).size() == 7);
+	CHECK(collect(g.edges_from("c")).empty());
+}
+
+TEST_CASE("the bound queries agree with a walk over every edge") {
+	using graph = gdwg::graph<int, int, std::allocator<int>, gdwg::hashed_lookup>;
+	auto g = graph{};
+	for (auto i = 0; i < 30; ++i) {
+		g.insert_node(i * 2);
+	}
+	auto rng = std::mt19937{11};
+	auto pick = std::uniform_int_distribution<int>{0, 29};
+	auto weight = std::uniform_int_distribution<int>{0, 9};
+	for (auto i = 0; i < 800; ++i) {
+		g.insert_edge(pick(rng) * 2, pick(rng) * 2, weight(rng));
+	}
+	auto all = std::vector<graph::value_type>(g.begin(), g.end());
+	using triple = std::tuple<int, int, int>;
+
+	for (auto src = 0; src < 60; src += 2) {
+		for (auto dst = -1; dst <= 60; ++dst) {
+			for (auto lo = -1; lo <= 10; lo += 3) {
+				auto hi = lo + 4;
+				auto expected = std::vector<triple>{};
+				for (auto const& e : all) {
+					if (e.from == src && e.to == dst && lo <= e.weight && e.weight < hi) {
+						expected.push_back(edge(e));
+					}
+				}
+				CHECK(collect(g.edges_between(src, dst, lo, hi)) == expected);
+			}
+			auto first = std::find_if(all.begin(), all.end(), [&](auto const& e) {
+				return e.from > src || (e.from == src && e.to >= dst);
+			});
+			auto i = g.lower_bound(src, dst);
+			CHECK(std::distance(g.begin(), i) == std::distance(all.begin(), first));
+		}
+		auto from = std::vector<triple>{};
+		for (auto const& e : all) {
+			if (e.from == src) {
+				from.push_back(edge(e));
+			}
+		}
+		CHECK(collect(g.edges_from(src)) == from);
+	}
+}
+
+TEST_CASE("the bound queries need src to be a node") {
+	auto g = gdwg::graph<int, int>{1};
+	CHECK_THROWS_WITH(g.lower_bound(2, 1),
+	                  "Cannot call gdwg::graph<N, E>::lower_bound if src doesn't exist in the graph");
+	CHECK_THROWS_WITH(g.upper_bound(2, 1, 0),
+	                  "Cannot call gdwg::graph<N, E>::upper_bound if src doesn't exist in the graph");
+	CHECK_THROWS_WITH(g.edges_between(2, 1),
+	                  "Cannot call gdwg::graph<N, E>::lower_bound if src doesn't exist in the graph");
+	CHECK_THROWS_WITH(g.edges_from(2),
+	                  "Cannot call gdwg::graph<N, E>::edges_from if src doesn't exist in the graph");
+}
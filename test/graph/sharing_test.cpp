@@ -0,0 +1,109 @@
+#include "gdwg/graph.hpp"
+
+#include <catch2/catch.hpp>
+#include <iterator>
+#include <memory_resource>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// This is the COPY-ON-WRITE SHARING TESTING file.
+
+namespace {
+	// A memory resource that counts the allocations passing through it.
+	class counting_resource : public std::pmr::memory_resource {
+	public:
+		std::size_t allocations = 0;
+
+	private:
+		auto do_allocate(std::size_t bytes, std::size_t align) -> void* override {
+			++allocations;
+			return std::pmr::new_delete_resource()->allocate(bytes, align);
+		}
+		auto do_deallocate(void* p, std::size_t bytes, std::size_t align) -> void override {
+			std::pmr::new_delete_resource()->deallocate(p, bytes, align);
+		}
+		auto do_is_equal(std::pmr::memory_resource const& other) const noexcept -> bool override {
+			return this == &other;
+		}
+	};
+
+	auto text(auto const& g) -> std::string {
+		auto os = std::ostringstream{};
+		os << g;
+		return os.str();
+	}
+} // namespace
+
+TEST_CASE("copies change independently of each other") {
+	auto g = gdwg::graph<std::string, int>{"A", "B", "C", "D"};
+	CHECK(g.insert_edge("A", "B", 1));
+	CHECK(g.insert_edge("A", "C", 2));
+	CHECK(g.insert_edge("B", "C", 3));
+	CHECK(g.insert_edge("C", "A", 4));
+	auto const before = text(g);
+
+	auto h = g;
+	CHECK(text(h) == before);
+	CHECK(h.insert_edge("A", "D", 5));
+	CHECK(h.erase_edge("B", "C", 3));
+	CHECK(h.erase_node("C"));
+	CHECK(text(g) == before);
+	CHECK(text(h) == "A(\n\tB | 1\n\tD | 5\n)\nB(\n)\nD(\n)\n");
+
+	// And the other way round.
+	auto k = g;
+	g.merge_replace_node("A", "D");
+	CHECK(text(k) == before);
+	CHECK(k.in_connections("A") == std::vector<std::string>{"C"});
+	CHECK(g.in_connections("D") == std::vector<std::string>{"C"});
+}
+
+TEST_CASE("a copy shares its edges until it changes them") {
+	auto resource = counting_resource{};
+	auto g = gdwg::pmr::graph<int, int>({0, 1, 2, 3}, &resource);
+	for (auto weight = 0; weight < 1000; ++weight) {
+		CHECK(g.insert_edge(weight % 4, (weight + 1) % 4, weight));
+	}
+	auto before = resource.allocations;
+	auto h = gdwg::pmr::graph<int, int>(g, g.get_allocator());
+	// One map entry per node, and the ID tables; nothing per edge.
+	CHECK(resource.allocations - before < 16);
+	CHECK(text(h) == text(g));
+
+	before = resource.allocations;
+	CHECK(h.insert_edge(0, 1, 1000));
+	// Only the edges of 0 and the sources of 1 are cloned, not the other 750 edges.
+	CHECK(resource.allocations - before < 10);
+	CHECK(h.weights(0, 1).size() == g.weights(0, 1).size() + 1);
+}
+
+TEST_CASE("replacing a shared node leaves the copy alone") {
+	auto g = gdwg::graph<std::string, int>{"A", "B", "C"};
+	CHECK(g.insert_edge("A", "B", 1));
+	auto h = g;
+	CHECK(h.replace_node("C", "D"));
+	CHECK(g.nodes() == std::vector<std::string>{"A", "B", "C"});
+	CHECK(h.nodes() == std::vector<std::string>{"A", "B", "D"});
+	CHECK(h.is_node("D"));
+	CHECK(!h.is_node("C"));
+	CHECK(g.is_node("C"));
+}
+
+TEST_CASE("erasing through iterators returns the next edge") {
+	auto g = gdwg::graph<int, int>{1, 2, 3};
+	CHECK(g.insert_edge(1, 2, 1));
+	CHECK(g.insert_edge(1, 2, 2));
+	CHECK(g.insert_edge(1, 3, 3));
+	CHECK(g.insert_edge(3, 1, 4));
+	auto h = g;
+	auto next = h.erase_edge(h.begin());
+	CHECK((*next).weight == 2);
+	next = h.erase_edge(next, std::next(next, 2));
+	CHECK((*next).from == 3);
+	CHECK((*next).weight == 4);
+	CHECK(h.erase_edge(next) == h.end());
+	CHECK(h.begin() == h.end());
+	// The original still has all of its edges.
+	CHECK(std::distance(g.begin(), g.end()) == 4);
+}
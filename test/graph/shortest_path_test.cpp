@@ -0,0 +1,72 @@
+#include "gdwg/shortest_path.hpp"
+
+#include <catch2/catch.hpp>
+#include <iostream>
+#include <random>
+#include <string>
+
+// This is the SHORTEST PATH TESTING file.
+
+TEST_CASE("dijkstra on a small graph") {
+	auto g = gdwg::graph<std::string, int>{"A", "B", "C", "D", "E"};
+	CHECK(g.insert_edge("A", "B", 4));
+	CHECK(g.insert_edge("A", "C", 1));
+	CHECK(g.insert_edge("C", "B", 2));
+	CHECK(g.insert_edge("B", "D", 5));
+	CHECK(g.insert_edge("C", "D", 8));
+	CHECK(g.insert_edge("D", "A", 1));
+	auto paths = gdwg::dijkstra(g, std::string("A"));
+	CHECK(paths.distance == std::map<std::string, int>{{"A", 0}, {"B", 3}, {"C", 1}, {"D", 8}});
+	CHECK(paths.predecessor == std::map<std::string, std::string>{{"B", "C"}, {"C", "A"}, {"D", "B"}});
+	// E can't be reached so it is in neither map.
+	CHECK(paths.distance.count("E") == 0);
+	CHECK_THROWS_AS(gdwg::dijkstra(g, std::string("Z")), std::runtime_error);
+	CHECK(g.insert_edge("E", "A", -1));
+	CHECK_THROWS_AS(gdwg::dijkstra(g, std::string("A")), std::runtime_error);
+}
+
+TEST_CASE("ties and zero weight edges give the same tree every time") {
+	auto g = gdwg::graph<int, int>{1, 2, 3, 4};
+	CHECK(g.insert_edge(1, 2, 1));
+	CHECK(g.insert_edge(1, 3, 1));
+	CHECK(g.insert_edge(2, 4, 1));
+	CHECK(g.insert_edge(3, 4, 1));
+	CHECK(g.insert_edge(4, 3, 0));
+	auto a = gdwg::dijkstra(g, 1);
+	auto b = gdwg::delta_stepping(g, 1, 1, 4);
+	CHECK(a.distance == b.distance);
+	CHECK(a.predecessor == b.predecessor);
+	CHECK(a.predecessor.at(4) == 2);
+	CHECK(a.predecessor.at(3) == 1);
+}
+
+TEST_CASE("delta_stepping agrees with dijkstra on random graphs") {
+	auto rng = std::mt19937{6771};
+	auto node = std::uniform_int_distribution<int>{0, 1999};
+	auto weight = std::uniform_int_distribution<int>{0, 100};
+	auto g = gdwg::graph<int, int>{};
+	auto h = gdwg::graph<int, double>{};
+	for (auto i = 0; i < 2000; ++i) {
+		g.insert_node(i);
+		h.insert_node(i);
+	}
+	for (auto i = 0; i < 20000; ++i) {
+		auto from = node(rng);
+		auto to = node(rng);
+		auto w = weight(rng);
+		g.insert_edge(from, to, w);
+		h.insert_edge(from, to, w / 7.0);
+	}
+	auto expected = gdwg::dijkstra(g, 0);
+	for (auto threads : {1U, 2U, 8U}) {
+		for (auto delta : {0, 1, 10, 1000}) {
+			auto actual = gdwg::delta_stepping(g, 0, delta, threads);
+			CHECK(actual.distance == expected.distance);
+			CHECK(actual.predecessor == expected.predecessor);
+		}
+	}
+	auto expected_double = gdwg::dijkstra(h, 0);
+	auto actual_double = gdwg::delta_stepping(h, 0, 0.5, 4);
+	CHECK(actual_double.distance == expected_double.distance);
+	CHECK(actual_double.predecessor == expected_double.predecessor);
+}
@@ -0,0 +1,59 @@
+#include "gdwg/spanning_tree.hpp"
+
+#include <catch2/catch.hpp>
+#include <random>
+#include <string>
+#include <vector>
+
+// This is the MINIMUM SPANNING TREE TESTING file.
+
+namespace {
+	template<typename Forest>
+	auto same_forest(Forest const& a, Forest const& b) -> bool {
+		return a.weight == b.weight
+		       && std::equal(a.edges.begin(), a.edges.end(), b.edges.begin(), b.edges.end(), [](auto const& x, auto const& y) {
+			          return x.from == y.from && x.to == y.to && x.weight == y.weight;
+		          });
+	}
+} // namespace
+
+TEST_CASE("kruskal on a small graph ignores edge directions") {
+	auto g = gdwg::graph<std::string, int>{"A", "B", "C", "D", "E"};
+	CHECK(g.insert_edge("A", "B", 4));
+	CHECK(g.insert_edge("C", "A", 1));
+	CHECK(g.insert_edge("B", "C", 2));
+	CHECK(g.insert_edge("B", "D", 5));
+	CHECK(g.insert_edge("D", "C", 8));
+	CHECK(g.insert_edge("D", "D", 0));
+	auto forest = gdwg::kruskal(g);
+	REQUIRE(forest.edges.size() == 3);
+	// The edges come back in iteration order. E has no edges, so it is a tree on its own.
+	CHECK(forest.edges[0].from == "B");
+	CHECK(forest.edges[0].to == "C");
+	CHECK(forest.edges[1].from == "B");
+	CHECK(forest.edges[1].to == "D");
+	CHECK(forest.edges[2].from == "C");
+	CHECK(forest.edges[2].to == "A");
+	CHECK(forest.weight == 8);
+	CHECK(same_forest(gdwg::boruvka(g, 2), forest));
+	CHECK(gdwg::kruskal(gdwg::graph<int, int>{}).edges.empty());
+}
+
+TEST_CASE("boruvka picks the same forest as kruskal on random graphs") {
+	auto rng = std::mt19937{6771};
+	auto node = std::uniform_int_distribution<int>{0, 2999};
+	// Few distinct weights, so lots of edges tie.
+	auto weight = std::uniform_int_distribution<int>{0, 5};
+	auto g = gdwg::graph<int, int>{};
+	for (auto i = 0; i < 3000; ++i) {
+		g.insert_node(i);
+	}
+	for (auto i = 0; i < 9000; ++i) {
+		g.insert_edge(node(rng), node(rng), weight(rng));
+	}
+	auto expected = gdwg::kruskal(g);
+	CHECK(expected.edges.size() == 3000 - gdwg::weakly_connected_components(g).size());
+	for (auto threads : {1U, 2U, 8U}) {
+		CHECK(same_forest(gdwg::boruvka(g, threads), expected));
+	}
+}
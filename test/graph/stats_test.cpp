@@ -0,0 +1,116 @@
+#define GDWG_GRAPH_STATS
+#include "gdwg/graph.hpp"
+
+#include <catch2/catch.hpp>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <utility>
+
+// This is the INSTRUMENTATION TESTING file.
+
+namespace {
+	auto bucket_total(gdwg::operation_stats const& op) -> std::uint64_t {
+		return std::accumulate(op.histogram.begin(), op.histogram.end(), std::uint64_t{0});
+	}
+} // namespace
+
+TEST_CASE("every modifier call is counted and timed") {
+	static_assert(gdwg::graph_stats::enabled);
+	auto g = gdwg::graph<std::string, int>{"a", "b", "c"};
+	CHECK(g.insert_edge("a", "b", 1));
+	CHECK(g.insert_edge("a", "c", 2));
+	CHECK(g.insert_edge("b", "c", 3));
+	CHECK(!g.insert_edge("b", "c", 3));
+	CHECK_THROWS_AS(g.insert_edge("a", "z", 4), std::runtime_error);
+	CHECK(g.erase_edge("b", "c", 3));
+	g.erase_edge(g.begin());
+	CHECK(g.erase_node("c"));
+	CHECK(g.insert_node("d"));
+	g.merge_replace_node("a", "d");
+
+	auto const s = g.stats();
+	CHECK(s.insert_node.calls == 4);
+	// Failed and throwing calls count too.
+	CHECK(s.insert_edge.calls == 5);
+	CHECK(s.erase_edge.calls == 2);
+	CHECK(s.erase_node.calls == 1);
+	CHECK(s.merge_replace_node.calls == 1);
+	CHECK(bucket_total(s.insert_edge) == s.insert_edge.calls);
+	CHECK(bucket_total(s.merge_replace_node) == 1);
+	CHECK(s.node_comparisons > 0);
+	CHECK(s.edge_comparisons > 0);
+}
+
+TEST_CASE("const queries count their comparisons") {
+	auto g = gdwg::graph<int, int>{1, 2, 3};
+	CHECK(g.insert_edge(1, 2, 1));
+	CHECK(g.insert_edge(1, 3, 1));
+	g.reset_stats();
+	CHECK(g.stats().node_comparisons == 0);
+	CHECK(g.stats().edge_comparisons == 0);
+
+	auto const& cg = g;
+	CHECK(cg.is_connected(1, 3));
+	auto const s = cg.stats();
+	CHECK(s.node_comparisons > 0);
+	CHECK(s.edge_comparisons > 0);
+	CHECK(s.insert_edge.calls == 0);
+}
+
+TEST_CASE("hashed lookup skips the node map comparisons") {
+	auto ordered = gdwg::graph<int, int>{1, 2, 3, 4, 5, 6, 7, 8};
+	auto hashed =
+	   gdwg::graph<int, int, std::allocator<int>, gdwg::hashed_lookup>{1, 2, 3, 4, 5, 6, 7, 8};
+	ordered.reset_stats();
+	hashed.reset_stats();
+	for (auto i = 1; i <= 8; ++i) {
+		CHECK(ordered.is_node(i));
+		CHECK(hashed.is_node(i));
+	}
+	CHECK(hashed.stats().node_comparisons == 0);
+	CHECK(ordered.stats().node_comparisons > 0);
+}
+
+TEST_CASE("stats belong to one graph") {
+	auto g = gdwg::graph<int, int>{1, 2};
+	auto copy = g;
+	CHECK(copy.stats().insert_node.calls == 0);
+	CHECK(copy.insert_edge(1, 2, 3));
+	CHECK(g.stats().insert_edge.calls == 0);
+
+	// Moving carries the counters along.
+	auto moved = std::move(g);
+	CHECK(moved.stats().insert_node.calls == 2);
+	moved = std::move(copy);
+	CHECK(moved.stats().insert_edge.calls == 1);
+	CHECK(moved.stats().insert_node.calls == 0);
+}
+
+TEST_CASE("a graph moved from keeps counters of its own") {
+	auto g = gdwg::graph<int, int>{1, 2};
+	{
+		auto other = gdwg::graph<int, int>{3};
+		other = std::move(g);
+		CHECK(other.stats().insert_node.calls == 2);
+		g = gdwg::graph<int, int>(std::move(other));
+	}
+	// The graph the counters were moved through is gone, and g's are still there.
+	CHECK(g.stats().insert_node.calls == 2);
+	CHECK(g.insert_node(4));
+	CHECK(g.stats().insert_node.calls == 3);
+	auto taken = std::move(g);
+	CHECK(taken.stats().insert_node.calls == 3);
+	CHECK_NOTHROW(g.stats());
+}
+
+TEST_CASE("the dump lists each modifier and its buckets") {
+	auto g = gdwg::graph<int, int>{1};
+	auto os = std::ostringstream{};
+	os << g.stats();
+	auto const text = os.str();
+	CHECK(text.find("insert_node: 1 calls, ") == 0);
+	CHECK(text.find("\t< 2^") != std::string::npos);
+	CHECK(text.find("insert_edge: 0 calls, 0 ns\nerase_node: 0 calls, 0 ns\n") != std::string::npos);
+	CHECK(text.find("edge comparisons: 0\n") != std::string::npos);
+}
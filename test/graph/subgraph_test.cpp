@@ -0,0 +1,135 @@
+#include "gdwg/graph.hpp"
+
+#include <catch2/catch.hpp>
+#include <random>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+// This is the SUBGRAPH AND FILTERED VIEW TESTING file.
+
+namespace {
+	auto text(auto const& g) -> std::string {
+		auto os = std::ostringstream{};
+		os << g;
+		return os.str();
+	}
+
+	template<typename View>
+	auto edges_of(View const& view) {
+		auto out = std::vector<std::tuple<int, int, int>>{};
+		for (auto const& [from, to, weight] : view) {
+			out.emplace_back(from, to, weight);
+		}
+		return out;
+	}
+
+	// The slow way: copy the graph and erase what isn't wanted.
+	template<typename G, typename NodePred, typename EdgePred>
+	auto erase_all_but(G g, NodePred keep_node, EdgePred keep_edge) -> G {
+		for (auto const& n : g.nodes()) {
+			if (!keep_node(n)) {
+				g.erase_node(n);
+			}
+		}
+		for (auto i = g.begin(); i != g.end();) {
+			auto const e = *i;
+			i = keep_edge(e.from, e.to, e.weight) ? std::next(i) : g.erase_edge(i);
+		}
+		return g;
+	}
+} // namespace
+
+TEST_CASE("subgraph keeps the given nodes and the edges between them") {
+	auto g = gdwg::graph<int, int>{1, 2, 3, 4};
+	CHECK(g.insert_edge(1, 2, 5));
+	CHECK(g.insert_edge(1, 3, 6));
+	CHECK(g.insert_edge(2, 1, 7));
+	CHECK(g.insert_edge(3, 3, 8));
+	CHECK(g.insert_edge(4, 1, 9));
+
+	auto view = g.subgraph({1, 3});
+	CHECK(view.nodes() == std::vector<int>{1, 3});
+	CHECK(view.is_node(3));
+	CHECK(!view.is_node(2));
+	CHECK(!view.is_node(7));
+	CHECK(edges_of(view) == std::vector<std::tuple<int, int, int>>{{1, 3, 6}, {3, 3, 8}});
+
+	auto h = view.materialize();
+	CHECK(h.nodes() == std::vector<int>{1, 3});
+	CHECK(h.is_connected(1, 3));
+	CHECK(h.weights(3, 3) == std::vector<int>{8});
+	CHECK(h.insert_edge(3, 1, 2));
+	CHECK(!g.is_connected(3, 1));
+	// The parent is left as it was.
+	CHECK(g.nodes() == std::vector<int>{1, 2, 3, 4});
+	CHECK(g.is_connected(4, 1));
+
+	CHECK_THROWS_WITH(g.subgraph({1, 5}),
+	                  "Cannot call gdwg::graph<N, E>::subgraph if a node doesn't exist in the graph");
+	CHECK(edges_of(g.subgraph(std::vector<int>{})).empty());
+}
+
+TEST_CASE("filter_view takes node and edge predicates") {
+	auto g = gdwg::graph<std::string, int>{"a", "b", "c"};
+	CHECK(g.insert_edge("a", "b", 1));
+	CHECK(g.insert_edge("a", "b", 2));
+	CHECK(g.insert_edge("b", "c", 3));
+	CHECK(g.insert_edge("c", "a", 4));
+
+	auto view = g.filter_view([](std::string const& n) { return n != "c"; },
+	                          [](std::string const&, std::string const&, int w) { return w % 2 == 0; });
+	auto count = 0;
+	for (auto const& [from, to, weight] : view) {
+		CHECK(from == "a");
+		CHECK(to == "b");
+		CHECK(weight == 2);
+		++count;
+	}
+	CHECK(count == 1);
+
+	auto h = view.materialize();
+	CHECK(h.nodes() == std::vector<std::string>{"a", "b"});
+	CHECK(h.weights("a", "b") == std::vector<int>{2});
+	CHECK(h.erase_node("b"));
+	CHECK(h.connections("a").empty());
+}
+
+TEST_CASE("materialize matches copying and erasing") {
+	using graph = gdwg::graph<int, int, std::allocator<int>, gdwg::hashed_lookup>;
+	auto g = graph{};
+	for (auto i = 0; i < 60; ++i) {
+		g.insert_node(i);
+	}
+	auto rng = std::mt19937{17};
+	auto pick = std::uniform_int_distribution<int>{0, 59};
+	for (auto i = 0; i < 900; ++i) {
+		g.insert_edge(pick(rng), pick(rng), i % 13);
+	}
+	// Erasing a few nodes first leaves holes in the IDs.
+	g.erase_node(5);
+	g.erase_node(40);
+
+	auto keep_node = [](int n) { return n % 3 != 0; };
+	auto keep_edge = [](int from, int to, int weight) { return (from + to + weight) % 4 != 0; };
+	auto expected = erase_all_but(g, keep_node, keep_edge);
+	auto view = g.filter_view(keep_node, keep_edge);
+	CHECK(edges_of(view) == edges_of(expected));
+	auto h = view.materialize();
+	CHECK(text(h) == text(expected));
+	for (auto n : h.nodes()) {
+		CHECK(h.connections(n) == expected.connections(n));
+		CHECK(h.node(h.node_id(n)) == n);
+	}
+	for (auto n : std::vector<int>{1, 2, 4}) {
+		for (auto m : std::vector<int>{7, 8, 10}) {
+			CHECK(h.is_connected(n, m) == expected.is_connected(n, m));
+		}
+	}
+
+	// Erasing from the copy keeps its reverse index right.
+	CHECK(h.erase_node(1));
+	CHECK(expected.erase_node(1));
+	CHECK(text(h) == text(expected));
+}
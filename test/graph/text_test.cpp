@@ -0,0 +1,132 @@
+#include "gdwg/text.hpp"
+
+#include <catch2/catch.hpp>
+#include <cstdio>
+#include <filesystem>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+// This is the TEXT IMPORT AND EXPORT TESTING file.
+
+namespace {
+	auto text(auto const& g) -> std::string {
+		auto os = std::ostringstream{};
+		os << g;
+		return os.str();
+	}
+
+	auto random_graph(int n, int m, unsigned seed) -> gdwg::graph<int, double> {
+		auto g = gdwg::graph<int, double>{};
+		for (auto i = 0; i < n; ++i) {
+			g.insert_node(i * 7);
+		}
+		auto rng = std::mt19937{seed};
+		auto pick = std::uniform_int_distribution<int>{0, n - 1};
+		for (auto i = 0; i < m; ++i) {
+			g.insert_edge(pick(rng) * 7, pick(rng) * 7, i / 8.0);
+		}
+		return g;
+	}
+
+	// A type with no codec of its own, so it goes through operator<< and operator>>.
+	struct point {
+		int x;
+		int y;
+		friend auto operator==(point const&, point const&) -> bool = default;
+		friend auto operator<(point const& a, point const& b) -> bool {
+			return a.x < b.x || (a.x == b.x && a.y < b.y);
+		}
+		friend auto operator<<(std::ostream& os, point const& p) -> std::ostream& {
+			return os << p.x << ',' << p.y;
+		}
+		friend auto operator>>(std::istream& is, point& p) -> std::istream& {
+			auto comma = char{};
+			return is >> p.x >> comma >> p.y;
+		}
+	};
+} // namespace
+
+TEST_CASE("write_text writes exactly what operator<< does") {
+	auto g = gdwg::graph<std::string, double>{"hello", "how", "are", "you?", "alone"};
+	CHECK(g.insert_edge("hello", "how", 5));
+	CHECK(g.insert_edge("hello", "are", 0.1234567));
+	CHECK(g.insert_edge("hello", "are", 1e20));
+	CHECK(g.insert_edge("how", "you?", -1.5));
+	CHECK(g.insert_edge("you?", "you?", 3));
+	auto os = std::ostringstream{};
+	gdwg::write_text(g, os);
+	CHECK(os.str() == text(g));
+}
+
+TEST_CASE("read_text reads back what operator<< wrote") {
+	auto g = gdwg::graph<std::string, int>{"a", "b", "c", "lonely"};
+	CHECK(g.insert_edge("a", "b", 1));
+	CHECK(g.insert_edge("a", "b", 2));
+	CHECK(g.insert_edge("c", "a", -4));
+	CHECK(g.insert_edge("b", "b", 7));
+	auto is = std::istringstream(text(g));
+	auto h = gdwg::read_text<std::string, int>(is);
+	CHECK(text(h) == text(g));
+	CHECK(h.is_node("lonely"));
+
+	auto empty = std::istringstream{};
+	CHECK(gdwg::read_text<std::string, int>(empty).empty());
+}
+
+TEST_CASE("values without a codec of their own go through the stream operators") {
+	auto g = gdwg::graph<point, int>{{1, 2}, {3, 4}};
+	CHECK(g.insert_edge({1, 2}, {3, 4}, 5));
+	auto os = std::ostringstream{};
+	gdwg::write_text(g, os);
+	CHECK(os.str() == text(g));
+	auto is = std::istringstream(os.str());
+	CHECK(text(gdwg::read_text<point, int>(is)) == text(g));
+}
+
+TEST_CASE("a large graph round trips through several buffers") {
+	auto g = random_graph(5000, 150000, 3);
+	auto os = std::ostringstream{};
+	gdwg::write_text(g, os);
+	REQUIRE(os.str().size() > 2 * gdwg::detail::text_buffer_size);
+	auto is = std::istringstream(os.str());
+	CHECK(text(gdwg::read_text<int, double>(is)) == text(g));
+}
+
+TEST_CASE("the parallel parse gives the same graph however the text is split") {
+	auto g = random_graph(3000, 40000, 5);
+	auto const dump = text(g);
+	for (auto threads : {1U, 2U, 3U, 8U}) {
+		CHECK(text(gdwg::parallel_parse_text<int, double>(dump, threads)) == text(g));
+	}
+	CHECK(gdwg::parallel_parse_text<int, double>("", 4).empty());
+}
+
+TEST_CASE("files go through a file descriptor or the parallel parse") {
+	auto g = random_graph(200, 1000, 7);
+	auto const path = std::filesystem::temp_directory_path() / "gdwg_text_test.txt";
+	auto* file = std::fopen(path.c_str(), "w");
+	REQUIRE(file != nullptr);
+	gdwg::write_text(g, ::fileno(file));
+	std::fclose(file);
+
+	file = std::fopen(path.c_str(), "r");
+	REQUIRE(file != nullptr);
+	CHECK(text(gdwg::read_text<int, double>(::fileno(file))) == text(g));
+	std::fclose(file);
+	CHECK(text(gdwg::parallel_read_text<int, double>(path, 2)) == text(g));
+	std::filesystem::remove(path);
+}
+
+TEST_CASE("text that operator<< couldn't have written is rejected") {
+	auto unterminated = std::istringstream("1(\n\t2 | 3\n");
+	CHECK_THROWS_AS((gdwg::read_text<int, int>(unterminated)), std::runtime_error);
+	auto no_bar = std::istringstream("1(\n\t2 3\n)\n");
+	CHECK_THROWS_AS((gdwg::read_text<int, int>(no_bar)), std::runtime_error);
+	auto not_a_number = std::istringstream("1(\n\t2 | x\n)\n");
+	CHECK_THROWS_AS((gdwg::read_text<int, int>(not_a_number)), std::runtime_error);
+	CHECK_THROWS_AS((gdwg::parallel_parse_text<int, int>("1(\n)\nz(\n)\n", 2)), std::runtime_error);
+}
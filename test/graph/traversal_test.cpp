@@ -0,0 +1,162 @@
+#include "gdwg/traversal.hpp"
+
+#include <catch2/catch.hpp>
+#include <random>
+#include <string>
+#include <vector>
+
+// This is the TRAVERSAL TESTING file.
+
+namespace {
+	// A random graph of n nodes and m edges. With dag set every edge goes from a smaller node
+	// to a larger one.
+	auto random_graph(int n, int m, unsigned seed, bool dag = false) -> gdwg::graph<int, int> {
+		auto g = gdwg::graph<int, int>{};
+		for (auto i = 0; i < n; ++i) {
+			g.insert_node(i);
+		}
+		auto rng = std::mt19937{seed};
+		auto pick = std::uniform_int_distribution<int>{0, n - 1};
+		for (auto i = 0; i < m; ++i) {
+			auto a = pick(rng);
+			auto b = pick(rng);
+			if (dag && a >= b) {
+				continue;
+			}
+			g.insert_edge(a, b, i % 3);
+		}
+		return g;
+	}
+} // namespace
+
+TEST_CASE("bfs counts the edges to every reachable node") {
+	auto g = gdwg::graph<std::string, int>{"A", "B", "C", "D", "E"};
+	CHECK(g.insert_edge("A", "B", 1));
+	CHECK(g.insert_edge("A", "B", 2));
+	CHECK(g.insert_edge("B", "C", 1));
+	CHECK(g.insert_edge("A", "C", 9));
+	CHECK(g.insert_edge("C", "D", 1));
+	CHECK(g.insert_edge("E", "A", 1));
+	auto expected = std::map<std::string, std::size_t>{{"A", 0}, {"B", 1}, {"C", 1}, {"D", 2}};
+	CHECK(gdwg::bfs(g, std::string("A")) == expected);
+	CHECK(gdwg::parallel_bfs(g, std::string("A"), 4) == expected);
+	CHECK(gdwg::bfs(g, std::string("D")) == std::map<std::string, std::size_t>{{"D", 0}});
+	CHECK_THROWS_AS(gdwg::bfs(g, std::string("Z")), std::runtime_error);
+	CHECK_THROWS_AS(gdwg::parallel_bfs(g, std::string("Z")), std::runtime_error);
+}
+
+TEST_CASE("parallel bfs matches bfs on large graphs") {
+	// Dense enough that the search switches to bottom up and back.
+	for (auto seed = 1U; seed <= 2; ++seed) {
+		auto g = random_graph(10000, 60000, seed);
+		CHECK(gdwg::parallel_bfs(g, 0, 4) == gdwg::bfs(g, 0));
+		CHECK(gdwg::parallel_bfs(g, 0, 1) == gdwg::bfs(g, 0));
+	}
+	// Long and thin, so it stays top down.
+	auto chain = random_graph(5000, 0, 1);
+	for (auto i = 0; i + 1 < 5000; ++i) {
+		chain.insert_edge(i, i + 1, 0);
+	}
+	auto depths = gdwg::parallel_bfs(chain, 0, 4);
+	CHECK(depths.size() == 5000);
+	CHECK(depths.at(4999) == 4999);
+}
+
+TEST_CASE("parallel edges count the same in both directions") {
+	auto g = gdwg::graph<int, int>{1, 2, 3};
+	for (auto w = 0; w < 5; ++w) {
+		CHECK(g.insert_edge(1, 2, w));
+	}
+	CHECK(g.insert_edge(3, 2, 0));
+	CHECK(gdwg::detail::degree(g, g.node_id(1), true) == 5);
+	CHECK(gdwg::detail::degree(g, g.node_id(2), false) == 6);
+	CHECK(gdwg::detail::degree(g, g.node_id(2), true) == 0);
+
+	// A multigraph dense enough to switch to bottom up.
+	auto multi = random_graph(3000, 20000, 3);
+	auto rng = std::mt19937{4};
+	auto pick = std::uniform_int_distribution<int>{0, 2999};
+	for (auto i = 0; i < 20000; ++i) {
+		auto a = pick(rng);
+		auto b = pick(rng);
+		for (auto w = 10; w < 14; ++w) {
+			multi.insert_edge(a, b, w);
+		}
+	}
+	CHECK(gdwg::parallel_bfs(multi, 0, 4) == gdwg::bfs(multi, 0));
+}
+
+TEST_CASE("connected components") {
+	auto g = gdwg::graph<int, int>{1, 2, 3, 4, 5, 6, 7};
+	CHECK(g.insert_edge(1, 2, 0));
+	CHECK(g.insert_edge(2, 3, 0));
+	CHECK(g.insert_edge(3, 1, 0));
+	CHECK(g.insert_edge(3, 4, 0));
+	CHECK(g.insert_edge(5, 4, 0));
+	CHECK(g.insert_edge(6, 6, 0));
+	using components = std::vector<std::vector<int>>;
+	CHECK(gdwg::weakly_connected_components(g) == components{{1, 2, 3, 4, 5}, {6}, {7}});
+	CHECK(gdwg::parallel_weakly_connected_components(g, 4)
+	      == components{{1, 2, 3, 4, 5}, {6}, {7}});
+	CHECK(gdwg::strongly_connected_components(g) == components{{1, 2, 3}, {4}, {5}, {6}, {7}});
+	CHECK(gdwg::parallel_strongly_connected_components(g, 4)
+	      == components{{1, 2, 3}, {4}, {5}, {6}, {7}});
+	CHECK(gdwg::weakly_connected_components(gdwg::graph<int, int>{}).empty());
+	CHECK(gdwg::parallel_strongly_connected_components(gdwg::graph<int, int>{}).empty());
+}
+
+TEST_CASE("parallel components match the sequential ones on large graphs") {
+	// Around one edge per node gives many components of all sizes.
+	for (auto seed = 1U; seed <= 2; ++seed) {
+		auto g = random_graph(10000, 11000, seed);
+		CHECK(gdwg::parallel_weakly_connected_components(g, 4)
+		      == gdwg::weakly_connected_components(g));
+		CHECK(gdwg::parallel_strongly_connected_components(g, 4)
+		      == gdwg::strongly_connected_components(g));
+	}
+	auto dense = random_graph(5000, 40000, 9);
+	auto strong = gdwg::strongly_connected_components(dense);
+	CHECK(gdwg::parallel_strongly_connected_components(dense, 4) == strong);
+	CHECK(gdwg::parallel_strongly_connected_components(dense, 1) == strong);
+}
+
+TEST_CASE("topological sort goes level by level") {
+	auto g =
+	   gdwg::graph<std::string, int>{"shirt", "tie", "jacket", "belt", "trousers", "shoes", "socks"};
+	CHECK(g.insert_edge("shirt", "tie", 0));
+	CHECK(g.insert_edge("tie", "jacket", 0));
+	CHECK(g.insert_edge("shirt", "belt", 0));
+	CHECK(g.insert_edge("belt", "jacket", 0));
+	CHECK(g.insert_edge("trousers", "belt", 0));
+	CHECK(g.insert_edge("trousers", "shoes", 0));
+	CHECK(g.insert_edge("trousers", "shoes", 1));
+	CHECK(g.insert_edge("socks", "shoes", 0));
+	auto expected =
+	   std::vector<std::string>{"shirt", "socks", "trousers", "belt", "shoes", "tie", "jacket"};
+	CHECK(gdwg::topological_sort(g) == expected);
+	CHECK(gdwg::parallel_topological_sort(g, 4) == expected);
+	CHECK(g.insert_edge("jacket", "shirt", 0));
+	CHECK_THROWS_AS(gdwg::topological_sort(g), std::runtime_error);
+	CHECK_THROWS_AS(gdwg::parallel_topological_sort(g, 4), std::runtime_error);
+	auto loop = gdwg::graph<int, int>{1};
+	CHECK(loop.insert_edge(1, 1, 0));
+	CHECK_THROWS_AS(gdwg::topological_sort(loop), std::runtime_error);
+}
+
+TEST_CASE("parallel topological sort matches on large graphs") {
+	auto g = random_graph(20000, 100000, 5, true);
+	auto order = gdwg::topological_sort(g);
+	CHECK(order.size() == 20000);
+	CHECK(gdwg::parallel_topological_sort(g, 4) == order);
+	auto position = std::vector<std::size_t>(order.size());
+	for (auto i = std::size_t{0}; i < order.size(); ++i) {
+		position[static_cast<std::size_t>(order[i])] = i;
+	}
+	auto ordered = true;
+	for (auto const& [from, to, weight] : g) {
+		auto a = position[static_cast<std::size_t>(from)];
+		auto b = position[static_cast<std::size_t>(to)];
+		ordered = ordered && a < b;
+	}
+	CHECK(ordered);
+}
@@ -0,0 +1,156 @@
+#include "gdwg/graph.hpp"
+#include "gdwg/weight_scan.hpp"
+
+#include <algorithm>
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// This is the WEIGHT SCAN TESTING file.
+
+namespace {
+	// Builds a node 0 with count edges whose weights step through a pattern with repeats and
+	// negatives, so the runs don't line up with the vector width.
+	template<typename E>
+	auto fan(int count) -> gdwg::graph<int, E> {
+		auto g = gdwg::graph<int, E>{0};
+		for (auto i = 0; i < count; ++i) {
+			g.insert_node(i + 1);
+			g.insert_edge(0, i + 1, static_cast<E>((i * 37) % 23 - 11));
+			if (i % 3 == 0) {
+				g.insert_edge(0, i + 1, static_cast<E>((i * 11) % 19 - 9));
+			}
+		}
+		return g;
+	}
+
+	// The same queries done one edge at a time through the iterator.
+	template<typename E>
+	auto expected_range(gdwg::graph<int, E> const& g, E lo, E hi) {
+		auto v = std::vector<typename gdwg::graph<int, E>::value_type>{};
+		for (auto const& [from, to, weight] : g) {
+			if (from == 0 && !(weight < lo) && !(hi < weight)) {
+				v.push_back({from, to, weight});
+			}
+		}
+		return v;
+	}
+
+	// Edges have no ==.
+	template<typename Edges>
+	auto same_edges(Edges const& a, Edges const& b) -> bool {
+		return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](auto const& x, auto const& y) {
+			return x.from == y.from && x.to == y.to && x.weight == y.weight;
+		});
+	}
+
+	template<typename E>
+	auto expected_summary(gdwg::graph<int, E> const& g) {
+		auto s = gdwg::weight_summary<E>{};
+		for (auto const& [from, to, weight] : g) {
+			if (from != 0) {
+				continue;
+			}
+			s.min = s.count == 0 || weight < s.min ? weight : s.min;
+			s.max = s.count == 0 || s.max < weight ? weight : s.max;
+			s.sum += weight;
+			++s.count;
+		}
+		return s;
+	}
+} // namespace
+
+TEMPLATE_TEST_CASE("weight scans agree with a plain walk over the edges",
+                   "",
+                   int,
+                   std::int64_t,
+                   float,
+                   double,
+                   short,
+                   unsigned) {
+	// Around and between the vector widths, so every tail length is covered.
+	for (auto count : {0, 1, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 100, 257}) {
+		auto const g = fan<TestType>(count);
+		auto const lo = static_cast<TestType>(std::is_signed_v<TestType> ? -3 : 2);
+		auto const hi = static_cast<TestType>(6);
+		CHECK(same_edges(gdwg::edges_in_weight_range(g, 0, lo, hi), expected_range(g, lo, hi)));
+		CHECK(gdwg::edges_in_weight_range(g, 0, hi, lo).empty());
+
+		auto const s = gdwg::out_weight_summary(g, 0);
+		auto const e = expected_summary(g);
+		CHECK(s.count == e.count);
+		CHECK(s.min == e.min);
+		CHECK(s.max == e.max);
+		// The weights are small whole numbers, so floating point sums are exact in any order.
+		CHECK(s.sum == e.sum);
+	}
+}
+
+TEST_CASE("weight scans only look at the edges of src") {
+	auto g = gdwg::graph<std::string, int>{"a", "b", "c"};
+	CHECK(g.insert_edge("a", "b", 1));
+	CHECK(g.insert_edge("b", "c", 2));
+	CHECK(g.insert_edge("c", "a", 3));
+	auto const v = gdwg::edges_in_weight_range(g, std::string{"b"}, 0, 10);
+	REQUIRE(v.size() == 1);
+	CHECK(v[0].from == "b");
+	CHECK(v[0].to == "c");
+	CHECK(v[0].weight == 2);
+
+	auto const s = gdwg::out_weight_summary(g, std::string{"c"});
+	CHECK(s.count == 1);
+	CHECK(s.sum == 3);
+	CHECK(gdwg::out_weight_summary(gdwg::graph<int, int>{1}, 1).count == 0);
+}
+
+TEST_CASE("weight scans handle extreme weights") {
+	auto g = gdwg::graph<int, double>{0, 1, 2};
+	auto const inf = std::numeric_limits<double>::infinity();
+	for (auto i = 0; i < 9; ++i) {
+		g.insert_edge(0, i % 2 + 1, static_cast<double>(i));
+	}
+	g.insert_edge(0, 2, -inf);
+	g.insert_edge(0, 1, inf);
+	auto const v = gdwg::edges_in_weight_range(g, 0, 2.0, 4.0);
+	CHECK(v.size() == 3);
+	CHECK(same_edges(v, expected_range(g, 2.0, 4.0)));
+
+	auto big = gdwg::graph<int, std::int64_t>{0, 1};
+	for (auto i = 0; i < 6; ++i) {
+		big.insert_edge(0, 1, std::numeric_limits<std::int64_t>::min() + i);
+		big.insert_edge(0, 1, std::numeric_limits<std::int64_t>::max() - i);
+	}
+	auto const s = gdwg::out_weight_summary(big, 0);
+	CHECK(s.min == std::numeric_limits<std::int64_t>::min());
+	CHECK(s.max == std::numeric_limits<std::int64_t>::max());
+	CHECK(gdwg::edges_in_weight_range(big, 0, std::int64_t{0}, std::int64_t{5}).empty());
+}
+
+TEST_CASE("integer sums that overflow wrap the same with or without vectors") {
+	// Few enough edges for the plain loop, then enough for whole vectors.
+	for (auto count : {3, 50}) {
+		auto g = gdwg::graph<int, std::int32_t>{0, 1};
+		auto expected = std::uint32_t{0};
+		for (auto i = 0; i < count; ++i) {
+			auto w = std::numeric_limits<std::int32_t>::max() - i;
+			g.insert_edge(0, 1, w);
+			expected += static_cast<std::uint32_t>(w);
+		}
+		CHECK(gdwg::out_weight_summary(g, 0).sum == static_cast<std::int32_t>(expected));
+	}
+}
+
+TEST_CASE("weight scans need src to be a node") {
+	auto g = gdwg::graph<int, int>{1};
+	CHECK_THROWS_MATCHES(gdwg::edges_in_weight_range(g, 2, 0, 1),
+	                     std::runtime_error,
+	                     Catch::Matchers::Message("Cannot call gdwg::edges_in_weight_range if src "
+	                                              "doesn't exist in the graph"));
+	CHECK_THROWS_MATCHES(gdwg::out_weight_summary(g, 2),
+	                     std::runtime_error,
+	                     Catch::Matchers::Message("Cannot call gdwg::out_weight_summary if src "
+	                                              "doesn't exist in the graph"));
+}